@@ -18,6 +18,21 @@ option(CHIMAERA_ENABLE_MIMALLOC "Use mimalloc as the allocator" @CHIMAERA_ENABLE
 option(CHIMAERA_ENABLE_PYTHON "Use pybind11" @CHIMAERA_ENABLE_PYTHON@)
 option(CHIMAERA_ENABLE_ROCM "Enable ROCm support" @CHIMAERA_ENABLE_ROCM@)
 option(CHIMAERA_ENABLE_CUDA "Enable CUDA support" @CHIMAERA_ENABLE_CUDA@)
+option(CHIMAERA_ENABLE_COROUTINES "Enable the C++20 co_await client API" @CHIMAERA_ENABLE_COROUTINES@)
+option(CHIMAERA_ENABLE_TASK_LOGS "Compile in per-task debug logging" @CHIMAERA_ENABLE_TASK_LOGS@)
+option(CHIMAERA_ENABLE_TRACE "Compile in binary task tracing" @CHIMAERA_ENABLE_TRACE@)
+
+if(CHIMAERA_ENABLE_COROUTINES)
+    add_compile_definitions(CHIMAERA_ENABLE_COROUTINES)
+endif()
+
+if(CHIMAERA_ENABLE_TASK_LOGS)
+    add_compile_definitions(CHIMAERA_ENABLE_TASK_LOGS)
+endif()
+
+if(CHIMAERA_ENABLE_TRACE)
+    add_compile_definitions(CHIMAERA_ENABLE_TRACE)
+endif()
 
 set(CHIMAERA_LIB_DIR @CHIMAERA_INSTALL_LIB_DIR@)
 set(CHIMAERA_INCLUDE_DIR @CHIMAERA_INSTALL_INCLUDE_DIR@)
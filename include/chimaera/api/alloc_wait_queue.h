@@ -0,0 +1,91 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Distributed under BSD 3-Clause license.                                   *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Illinois Institute of Technology.                        *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of Hermes. The full Hermes copyright notice, including  *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the top directory. If you do not  *
+ * have access to the file, you may request a copy from help@hdfgroup.org.   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHI_INCLUDE_CHI_API_ALLOC_WAIT_QUEUE_H_
+#define CHI_INCLUDE_CHI_API_ALLOC_WAIT_QUEUE_H_
+
+#include <atomic>
+
+#include "chimaera/chimaera_types.h"
+
+namespace chi {
+
+/**
+ * A FIFO of threads waiting for an allocator to free memory.
+ * It lives in shared memory so client threads and runtime coroutines
+ * queue behind each other. Waiters take tickets in arrival order. Only the
+ * head retries the allocator, once per free; the rest only recheck their
+ * position. A nonempty queue also stops new allocations from jumping ahead
+ * of the waiters.
+ * */
+struct AllocWaitQueue {
+  std::atomic<u64> tail_; /**< Next ticket to hand out */
+  std::atomic<u64> head_; /**< Ticket allowed to retry the allocator */
+  std::atomic<u32> gen_;  /**< Bumped on every free or dequeue (futex) */
+
+  /** Initialize the queue (runtime only) */
+  void shm_init() {
+    tail_ = 0;
+    head_ = 0;
+    gen_ = 0;
+  }
+
+  /** Whether any thread waits for memory */
+  HSHM_INLINE_CROSS_FUN
+  bool HasWaiters() const { return head_.load() != tail_.load(); }
+
+  /** Take a ticket */
+  HSHM_INLINE_CROSS_FUN
+  u64 Enqueue() { return tail_.fetch_add(1); }
+
+  /** Whether \a ticket is at the head of the queue */
+  HSHM_INLINE_CROSS_FUN
+  bool IsHead(u64 ticket) const { return head_.load() == ticket; }
+
+  /** Get the wake generation. Read before checking the wait condition. */
+  HSHM_INLINE_CROSS_FUN
+  u32 GetGeneration() const { return gen_.load(); }
+
+  /** The head was served. Let the next waiter retry. */
+  HSHM_INLINE_CROSS_FUN
+  void Dequeue() {
+    head_.fetch_add(1);
+    Wake();
+  }
+
+  /** Memory was freed. Wake the waiters if there are any. */
+  HSHM_INLINE_CROSS_FUN
+  void Notify() {
+    if (HasWaiters()) {
+      Wake();
+    }
+  }
+
+  /** Bump the generation and wake sleeping client threads */
+  HSHM_INLINE_CROSS_FUN
+  void Wake() {
+    gen_.fetch_add(1);
+#ifdef HSHM_IS_HOST
+    WakeSlow();
+#endif
+  }
+
+  /** Sleep until the generation moves past \a gen (client threads) */
+  void WaitStd(u32 gen);
+
+  /** Issue the futex wake */
+  void WakeSlow();
+};
+
+}  // namespace chi
+
+#endif  // CHI_INCLUDE_CHI_API_ALLOC_WAIT_QUEUE_H_
@@ -13,41 +13,117 @@
 #ifndef CHI_INCLUDE_CHI_CLIENT_CHI_CLIENT_H_
 #define CHI_INCLUDE_CHI_CLIENT_CHI_CLIENT_H_
 
+#include <sched.h>
+
+#include <thread>
+
 #include "chimaera_client_defn.h"
 
 namespace chi {
 
-/** Allocate a buffer */
+/** Try to allocate a buffer once */
+HSHM_INLINE_CROSS_FUN FullPtr<char> Client::TryAllocateBuffer(
+    const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, size_t size) {
+  FullPtr<char> p;
+  try {
+    p = alloc->AllocateLocalPtr<char>(alloc.ctx_, size);
+  } catch (hshm::Error &e) {
+    p.shm_.SetNull();
+  }
+  return p;
+}
+
+/** Allocate a buffer, waiting in FIFO order while memory is exhausted */
 template <bool FROM_REMOTE>
 HSHM_INLINE_CROSS_FUN FullPtr<char> Client::AllocateBufferSafe(
-    const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, size_t size) {
+    const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, AllocWaitQueue &waitq,
+    size_t size) {
 #ifdef HSHM_IS_HOST
   FullPtr<char> p;
-  while (true) {
-    try {
-      p = alloc->AllocateLocalPtr<char>(alloc.ctx_, size);
-    } catch (hshm::Error &e) {
-      p.shm_.SetNull();
-    }
+  if (!waitq.HasWaiters()) {
+    p = TryAllocateBuffer(alloc, size);
     if (!p.shm_.IsNull()) {
-      break;
+      return p;
     }
-    if constexpr (FROM_REMOTE) {
-      Task::StaticYieldFactory<TASK_YIELD_ABT>();
+  }
+  // Queue behind earlier waiters. Only the head retries the allocator.
+  u64 ticket = waitq.Enqueue();
+  while (true) {
+    u32 gen = waitq.GetGeneration();
+    if (waitq.IsHead(ticket)) {
+      p = TryAllocateBuffer(alloc, size);
+      if (!p.shm_.IsNull()) {
+        break;
+      }
     }
+    // Wait for a free or a new head
+    while (waitq.GetGeneration() == gen) {
+      if constexpr (FROM_REMOTE) {
+        Task::StaticYieldFactory<TASK_YIELD_ABT>();
+      }
 #ifdef CHIMAERA_RUNTIME
-    Task *task = CHI_CUR_TASK;
-    task->Yield();
+      Task *task = CHI_CUR_TASK;
+      task->Yield();
 #else
-    Task::StaticYieldFactory<TASK_YIELD_STD>();
+      waitq.WaitStd(gen);
 #endif
+    }
   }
+  waitq.Dequeue();
   return p;
 #else
   return FullPtr<char>();
 #endif
 }
 
+/** Submissions between re-reads of a thread's CPU for its lane hint */
+#define CHI_LANE_HINT_REFRESH 64
+
+#ifdef HSHM_IS_HOST
+/** The CPU the thread runs on, or a per-thread value if it is unknown */
+HSHM_INLINE u32 GetCpuLaneHint() {
+  int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return (u32)cpu;
+  }
+  return (u32)std::hash<std::thread::id>{}(std::this_thread::get_id());
+}
+#endif
+
+/** Choose the ingress lane hash for a task */
+template <typename TaskT>
+HSHM_INLINE_CROSS_FUN u32 Client::GetIngressLaneHash(
+    ingress::MultiQueue *queue, const FullPtr<TaskT> &task) {
+#ifdef HSHM_IS_HOST
+  if (routed_lanes_) {
+    // Submit to the worker that owns the task's container lane
+    u32 lane_id;
+    u64 key = RouteTable::GetKey(task->pool_, task->dom_query_);
+    if (header_->route_table_.Find(key, lane_id)) {
+      return lane_id;
+    }
+  }
+  if (thread_affine_lanes_) {
+    // Per-thread lane, chosen by the CPU the thread runs on. The CPU is
+    // re-read periodically and after a spill, so the hint follows the
+    // thread when it migrates.
+    static thread_local u32 lane_hint = GetCpuLaneHint();
+    static thread_local u32 hint_uses = 0;
+    if (++hint_uses >= CHI_LANE_HINT_REFRESH) {
+      hint_uses = 0;
+      lane_hint = GetCpuLaneHint();
+    }
+    u32 lane_hash =
+        queue->GetSpillLaneHash(chi::TaskPrioOpt::kLowLatency, lane_hint);
+    if (lane_hash != lane_hint) {
+      hint_uses = CHI_LANE_HINT_REFRESH;
+    }
+    return lane_hash;
+  }
+#endif
+  return hshm::hash<chi::DomainQuery>{}(task->dom_query_);
+}
+
 /** Send a task to the runtime */
 template <typename TaskT>
 HSHM_INLINE_CROSS_FUN void Client::ScheduleTask(Task *parent_task,
@@ -55,26 +131,127 @@ HSHM_INLINE_CROSS_FUN void Client::ScheduleTask(Task *parent_task,
 #ifndef CHIMAERA_RUNTIME
   chi::ingress::MultiQueue *queue =
       CHI_CLIENT->GetQueue(CHI_QM->process_queue_id_);
-  HILOG(kInfo, "Scheduling task (client, prior): {} dom={}", task->task_node_,
-        task->dom_query_);
-  queue->Emplace(chi::TaskPrioOpt::kLowLatency,
-                 hshm::hash<chi::DomainQuery>{}(task->dom_query_), task.shm_);
-  HILOG(kInfo, "Scheduling task (client): {} dom={}", task->task_node_,
-        task->dom_query_);
+  CHI_TASK_LOG("Scheduling task (client): {} dom={}", task->task_node_,
+               task->dom_query_);
+  CHI_TRACE(kSchedule, task->task_node_);
+  u32 lane_hash = GetIngressLaneHash(queue, task);
+  while (!queue->Emplace(chi::TaskPrioOpt::kLowLatency, lane_hash,
+                         task.shm_)) {
+    // The lane is full: retry on the next lane with room
+    HSHM_THREAD_MODEL->Yield();
+    lane_hash =
+        queue->GetSpillLaneHash(chi::TaskPrioOpt::kLowLatency, lane_hash + 1);
+  }
 #else
-  HILOG(kInfo, "Scheduling task (runtime, prior): {} dom={}", task->task_node_,
-        task->dom_query_);
+  CHI_TASK_LOG("Scheduling task (runtime): {} dom={}", task->task_node_,
+               task->dom_query_);
+  CHI_TRACE(kSchedule, task->task_node_);
   task->YieldInit(parent_task);
   Worker *cur_worker = CHI_CUR_WORKER;
   if (!cur_worker) {
     cur_worker = &CHI_WORK_ORCHESTRATOR->GetWorker(0);
   }
   cur_worker->active_.push(task);
-  HILOG(kInfo, "Scheduling task (runtime): {} dom={}", task->task_node_,
-        task->dom_query_);
 #endif
 }
 
+/** Send a batch of constructed tasks to the runtime */
+template <typename TaskT>
+HSHM_INLINE_CROSS_FUN void Client::ScheduleTasks(Task *parent_task,
+                                                 const FullPtr<TaskT> *tasks,
+                                                 size_t count) {
+  if (count == 0) {
+    return;
+  }
+#ifndef CHIMAERA_RUNTIME
+  // Plug check, lane selection and in-flight registration happen once
+  // per lane, not once per task
+  chi::ingress::MultiQueue *queue =
+      CHI_CLIENT->GetQueue(CHI_QM->process_queue_id_);
+  u32 lane_hash = GetIngressLaneHash(queue, tasks[0]);
+  chi::ingress::Lane *lane =
+      &queue->BeginEmplace(chi::TaskPrioOpt::kLowLatency, lane_hash);
+  for (size_t i = 0; i < count; ++i) {
+    CHI_TRACE(kSchedule, tasks[i]->task_node_);
+    while (lane->emplace(chi::ingress::LaneData(tasks[i].shm_)).IsNull()) {
+      // The lane is full: release it so a resize can proceed, and
+      // continue the batch on the next lane with room
+      queue->EndEmplace(*lane);
+      HSHM_THREAD_MODEL->Yield();
+      lane_hash = queue->GetSpillLaneHash(chi::TaskPrioOpt::kLowLatency,
+                                          lane_hash + 1);
+      lane = &queue->BeginEmplace(chi::TaskPrioOpt::kLowLatency, lane_hash);
+    }
+  }
+  queue->EndEmplace(*lane);
+#else
+  for (size_t i = 0; i < count; ++i) {
+    ScheduleTask(parent_task, tasks[i]);
+  }
+#endif
+}
+
+/** Submit a task DAG */
+template <typename TaskT>
+HSHM_INLINE void Client::ScheduleDag(Task *parent_task,
+                                     const FullPtr<TaskT> *tasks,
+                                     size_t count) {
+  std::vector<FullPtr<TaskT>> roots;
+  roots.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (!tasks[i]->HasDagDeps()) {
+      roots.emplace_back(tasks[i]);
+    }
+  }
+  ScheduleTasks<TaskT>(parent_task, roots.data(), roots.size());
+}
+
+/** Submit tasks as a group */
+template <typename TaskT>
+HSHM_INLINE_CROSS_FUN void Client::ScheduleGroup(Task *parent_task,
+                                                 const FullPtr<TaskT> *tasks,
+                                                 size_t count) {
+  static_assert(TaskT::CMPGRP, "This task type cannot be grouped");
+  if (count == 0) {
+    return;
+  }
+  const FullPtr<TaskT> &leader = tasks[0];
+  GetOrCreateLinks(HSHM_DEFAULT_MEM_CTX, leader.ptr_).grp_pending_ = count;
+  for (size_t i = 0; i < count; ++i) {
+    if (tasks[i]->pool_ != leader->pool_ || tasks[i]->IsFireAndForget()) {
+      HELOG(kFatal, "Grouped tasks must share a pool and be waited on");
+    }
+    TaskLinks &links = GetOrCreateLinks(HSHM_DEFAULT_MEM_CTX, tasks[i].ptr_);
+    links.grp_leader_ = leader.shm_;
+    links.grp_next_ =
+        (i + 1 < count) ? tasks[i + 1].shm_ : hipc::Pointer::GetNull();
+  }
+  // The runtime routes the rest of the group behind the leader
+  ScheduleTask(parent_task, leader);
+}
+
+#ifdef CHIMAERA_RUNTIME
+/** Start the DAG successors of a completed task */
+HSHM_INLINE void Client::ReleaseDagEdges(const FullPtr<Task> &task) {
+  TaskLinks *links = task->GetLinks();
+  hipc::Pointer edge_p = links->dag_edges_;
+  links->dag_edges_ = hipc::Pointer::GetNull();
+  while (!edge_p.IsNull()) {
+    FullPtr<DagEdge> edge(edge_p);
+    FullPtr<Task> child(edge->child_);
+    TaskLinks *child_links = child->GetLinks();
+    if (edge->pass_output_) {
+      child_links->dag_input_ = task.shm_;
+    }
+    edge_p = edge->next_;
+    main_alloc_->DelObjLocal<DagEdge>(HSHM_DEFAULT_MEM_CTX, edge);
+    if (child_links->dag_deps_.fetch_sub(1) == 1) {
+      ScheduleTask(nullptr, child);
+    }
+  }
+}
+#endif
+
 /** Allocate + send a task to the runtime */
 template <typename TaskT, typename... Args>
 HSHM_INLINE_CROSS_FUN hipc::FullPtr<TaskT> Client::ScheduleNewTask(
@@ -22,18 +22,49 @@
 #include "chimaera/work_orchestrator/work_orchestrator.h"
 #endif
 #include "chimaera/module_registry/task.h"
+#include "chimaera/monitor/trace.h"
 
 // Singleton macros
 #define CHI_CLIENT hshm::CrossSingleton<chi::Client>::GetInstance()
 #define CHI_CLIENT_T chi::Client *
 
+/** # of task ids a thread reserves from the shared counter at a time */
+#define CHI_TASK_ID_BLOCK 4096
+
 namespace chi {
 
+/**
+ * A client-owned shared-memory region the runtime addresses directly.
+ * Tasks reference offsets in it, so I/O needs no staging copy into
+ * the data allocator.
+ * */
+struct RegisteredBuffer {
+  u32 id_ = 0;          /**< Index among registered buffers */
+  std::string name_;    /**< Name of the shared-memory region */
+  FullPtr<char> base_;  /**< Start of the usable region */
+  size_t size_ = 0;     /**< Size of the usable region */
+
+  /** Whether registration failed */
+  bool IsNull() const { return base_.shm_.IsNull(); }
+
+  /** Get a task-addressable pointer at offset \a off of the region */
+  FullPtr<char> Get(size_t off) const {
+    FullPtr<char> p;
+    p.ptr_ = base_.ptr_ + off;
+    p.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(p.ptr_);
+    return p;
+  }
+};
+
 class Client : public ConfigurationManager {
  public:
   int data_;
   hipc::atomic<hshm::min_u64> *unique_;
   NodeId node_id_;
+  bool thread_affine_lanes_ = false; /**< Each thread has a sticky lane */
+  bool routed_lanes_ = false;        /**< Follow runtime route hints */
+  TaskSlab task_slab_;               /**< Per-size-class task pools */
+  TaskSlab data_slab_;               /**< Per-size-class data buffer pools */
 
  public:
   /** Default constructor */
@@ -74,39 +105,130 @@ class Client : public ConfigurationManager {
   HSHM_INLINE_CROSS_FUN
   void Finalize() {}
 
-  /** Create task node id */
+  /**
+   * Create task node id. Host threads reserve CHI_TASK_ID_BLOCK ids from
+   * the shared counter at a time, so ids stay unique across processes
+   * without an atomic per task.
+   * */
   HSHM_INLINE_CROSS_FUN
   TaskNode MakeTaskNodeId() {
+#ifdef HSHM_IS_HOST
+    static thread_local u64 next_id = 0;
+    static thread_local u64 end_id = 0;
+    if (next_id == end_id) {
+      next_id = unique_->fetch_add(CHI_TASK_ID_BLOCK);
+      end_id = next_id + CHI_TASK_ID_BLOCK;
+    }
+    return TaskId(header_->node_id_, next_id++);
+#else
     return TaskId(header_->node_id_, unique_->fetch_add(1));
+#endif
   }
 
-  /** Create a unique ID */
+  /** Create a pool ID. Pool ids are dense, so they index pool tables. */
   HSHM_INLINE_CROSS_FUN
   PoolId MakePoolId() {
-    return PoolId(header_->node_id_, unique_->fetch_add(1));
+    return PoolId(header_->node_id_, header_->pool_unique_.fetch_add(1));
+  }
+
+  /**
+   * Allocate an unconstructed task block from the slab.
+   * The block is preceded by a SlabHeader recording its size class.
+   * */
+  template <typename TaskT>
+  HSHM_INLINE_CROSS_FUN FullPtr<TaskT> AllocateTaskBlock(
+      const hipc::MemContext &mctx) {
+    size_t full_size = sizeof(TaskT) + sizeof(SlabHeader);
+    FullPtr<char> blk;
+    u64 slab_size = 0;
+#ifdef HSHM_IS_HOST
+    if (task_slab_.IsSlabSize(full_size)) {
+      blk = task_slab_.Allocate(mctx, full_size);
+      slab_size = full_size;
+    }
+#endif
+    if (blk.shm_.IsNull()) {
+      blk = main_alloc_->AllocateLocalPtr<char>(mctx, full_size);
+      slab_size = 0;
+    }
+    return SetSlabHeader(blk, slab_size).template Cast<TaskT>();
+  }
+
+  /**
+   * Destruct a task and return its block to where it came from.
+   * The size class is read from the block, not from TaskT.
+   * */
+  template <typename TaskT>
+  HSHM_INLINE_CROSS_FUN void FreeTaskBlock(const hipc::MemContext &mctx,
+                                           TaskT *task) {
+#if defined(CHIMAERA_RUNTIME) && defined(HSHM_IS_HOST)
+    task->FreeRunContext();
+#endif
+    if (!task->links_.IsNull()) {
+      FullPtr<TaskLinks> links(task->links_);
+      main_alloc_->DelObjLocal<TaskLinks>(mctx, links);
+    }
+    task->~TaskT();
+    char *data = reinterpret_cast<char *>(task);
+    SlabHeader *hdr = GetSlabHeader(data);
+    if (hdr->magic_ != CHI_SLAB_MAGIC) {
+      HELOG(kFatal, "Task {} was not allocated by AllocateTaskBlock",
+            (void *)task);
+      return;
+    }
+    hdr->magic_ = 0;
+#ifdef HSHM_IS_HOST
+    if (hdr->slab_size_) {
+      task_slab_.Free(reinterpret_cast<char *>(hdr), hdr->slab_size_);
+      return;
+    }
+#endif
+    FullPtr<char> blk;
+    blk.ptr_ = reinterpret_cast<char *>(hdr);
+    blk.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(blk.ptr_);
+    main_alloc_->FreeLocalPtr(hshm::ThreadId::GetNull(), blk);
+  }
+
+  /** Write the SlabHeader of a block. Returns the memory after it. */
+  HSHM_INLINE_CROSS_FUN
+  static FullPtr<char> SetSlabHeader(FullPtr<char> blk, u64 slab_size) {
+    if (blk.shm_.IsNull()) {
+      return blk;
+    }
+    SlabHeader *hdr = reinterpret_cast<SlabHeader *>(blk.ptr_);
+    hdr->magic_ = CHI_SLAB_MAGIC;
+    hdr->slab_size_ = slab_size;
+    blk.ptr_ += sizeof(SlabHeader);
+    blk.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(blk.ptr_);
+    return blk;
+  }
+
+  /** Get the SlabHeader preceding a block's memory */
+  HSHM_INLINE_CROSS_FUN
+  static SlabHeader *GetSlabHeader(char *data) {
+    return reinterpret_cast<SlabHeader *>(data - sizeof(SlabHeader));
   }
 
   /** Create a default-constructed task */
   template <typename TaskT, typename... Args>
   HSHM_INLINE_CROSS_FUN TaskT *NewEmptyTask(const hipc::MemContext &mctx,
                                             hipc::Pointer &p) {
-    TaskT *task = main_alloc_->NewObj<TaskT>(mctx, p, main_alloc_);
-    if (task == nullptr) {
-      // throw std::runtime_error("Could not allocate buffer");
-      HELOG(kFatal, "Could not allocate buffer (1)");
-    }
-    return task;
+    FullPtr<TaskT> task = NewEmptyTask<TaskT>(mctx);
+    p = task.shm_;
+    return task.ptr_;
   }
 
   /** Create a default-constructed task */
   template <typename TaskT, typename... Args>
   HSHM_INLINE_CROSS_FUN FullPtr<TaskT> NewEmptyTask(
       const hipc::MemContext &mctx) {
-    FullPtr<TaskT> task = main_alloc_->NewObjLocal<TaskT>(mctx, main_alloc_);
+    FullPtr<TaskT> task = AllocateTaskBlock<TaskT>(mctx);
     if (task.shm_.IsNull()) {
       // throw std::runtime_error("Could not allocate buffer");
       HELOG(kFatal, "Could not allocate buffer (2)");
+      return task;
     }
+    hipc::Allocator::ConstructObj<TaskT>(*task.ptr_, main_alloc_);
     return task;
   }
 
@@ -119,15 +241,22 @@ class Client : public ConfigurationManager {
         std::forward<Args>(args)...);
   }
 
-  /** Allocate task */
+  /**
+   * Allocate an unconstructed task. The fields the runtime tests before
+   * a task is constructed (run context, links, completion queue) are
+   * cleared, since the block may hold stale memory.
+   * */
   template <typename TaskT, typename... Args>
   HSHM_INLINE_CROSS_FUN hipc::FullPtr<TaskT> AllocateTask(
       const hipc::MemContext &mctx) {
-    hipc::FullPtr<TaskT> task =
-        main_alloc_->AllocateLocalPtr<TaskT>(mctx, sizeof(TaskT));
+    hipc::FullPtr<TaskT> task = AllocateTaskBlock<TaskT>(mctx);
     if (task.shm_.IsNull()) {
       HELOG(kFatal, "Could not allocate buffer (3)");
+      return task;
     }
+    task->rctx_ = nullptr;
+    task->links_ = hipc::Pointer::GetNull();
+    task->cq_ = hipc::Pointer::GetNull();
     return task;
   }
 
@@ -136,16 +265,53 @@ class Client : public ConfigurationManager {
   HSHM_INLINE_CROSS_FUN FullPtr<TaskT> NewTask(const hipc::MemContext &mctx,
                                                const TaskNode &task_node,
                                                Args &&...args) {
-    FullPtr<TaskT> ptr = main_alloc_->NewObjLocal<TaskT>(
-        mctx, hipc::CtxAllocator<CHI_ALLOC_T>{main_alloc_, mctx}, task_node,
-        std::forward<Args>(args)...);
+    FullPtr<TaskT> ptr = AllocateTaskBlock<TaskT>(mctx);
     if (ptr.shm_.IsNull()) {
       // throw std::runtime_error("Could not allocate buffer");
       HELOG(kFatal, "Could not allocate buffer (4)");
+      return ptr;
     }
+    ConstructTask<TaskT>(mctx, ptr.ptr_, task_node,
+                         std::forward<Args>(args)...);
     return ptr;
   }
 
+  /** Create a completion queue for reaping finished tasks in batches */
+  HSHM_INLINE_CROSS_FUN
+  FullPtr<ingress::CompletionQueue> NewCompletionQueue(
+      const hipc::MemContext &mctx, size_t depth) {
+    FullPtr<ingress::CompletionQueue> cq =
+        main_alloc_->NewObjLocal<ingress::CompletionQueue>(
+            mctx, hipc::CtxAllocator<CHI_ALLOC_T>{main_alloc_, mctx}, depth);
+    if (cq.shm_.IsNull()) {
+      HELOG(kFatal, "Could not allocate completion queue");
+    }
+    return cq;
+  }
+
+  /** Destroy a completion queue */
+  HSHM_INLINE_CROSS_FUN
+  void DelCompletionQueue(const hipc::MemContext &mctx,
+                          FullPtr<ingress::CompletionQueue> &cq) {
+    cq->shm_destroy();
+    main_alloc_->DelObjLocal<ingress::CompletionQueue>(mctx, cq);
+  }
+
+  /**
+   * Reap up to \a max completed tasks. Returns the number reaped.
+   * Reaped tasks are complete and may be freed by the caller.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  size_t ReapCompletions(FullPtr<ingress::CompletionQueue> &cq,
+                         FullPtr<Task> *tasks, size_t max) {
+    size_t count = 0;
+    ingress::LaneData entry;
+    while (count < max && !cq->pop(entry).IsNull()) {
+      tasks[count++] = FullPtr<Task>(entry);
+    }
+    return count;
+  }
+
   /** Call duplicate if applicable */
   template <typename TaskT>
   constexpr inline void CopyTask(const TaskT *orig_task, TaskT *dup_task,
@@ -206,7 +372,7 @@ class Client : public ConfigurationManager {
 #ifdef CHIMAERA_TASK_DEBUG
     MonitorTaskFrees(task);
 #else
-    main_alloc_->DelObj<TaskT>(mctx, task);
+    FreeTaskBlock<TaskT>(mctx, task);
 #endif
   }
 
@@ -217,7 +383,7 @@ class Client : public ConfigurationManager {
 #ifdef CHIMAERA_TASK_DEBUG
     MonitorTaskFrees(task);
 #else
-    main_alloc_->DelObjLocal<TaskT>(mctx, task);
+    FreeTaskBlock<TaskT>(mctx, task.ptr_);
 #endif
   }
 
@@ -245,10 +411,28 @@ class Client : public ConfigurationManager {
   }
 #endif
 
-  /** Allocate a buffer */
+  /**
+   * Allocate a buffer. Small buffers come from the thread's slab cache.
+   * Every data buffer, on every path, is preceded by a SlabHeader saying
+   * where it came from, so FreeBuffer does not need its size.
+   * */
   HSHM_INLINE_CROSS_FUN
   FullPtr<char> AllocateBuffer(const hipc::MemContext &mctx, size_t size) {
-    return AllocateBufferSafe<false>({mctx, data_alloc_}, size);
+    size_t full_size = size + sizeof(SlabHeader);
+    FullPtr<char> p;
+    u64 slab_size = 0;
+#ifdef HSHM_IS_HOST
+    if (data_slab_.IsSlabSize(full_size)) {
+      p = data_slab_.Allocate(mctx, full_size);
+      slab_size = full_size;
+    }
+#endif
+    if (p.shm_.IsNull()) {
+      p = AllocateBufferSafe<false>({mctx, data_alloc_}, header_->data_waitq_,
+                                    full_size);
+      slab_size = 0;
+    }
+    return SetSlabHeader(p, slab_size);
   }
 
   /** Allocate a buffer (used in remote queue only) */
@@ -256,30 +440,130 @@ class Client : public ConfigurationManager {
   HSHM_INLINE
   FullPtr<char> AllocateBufferRemote(const hipc::MemContext &mctx,
                                      size_t size) {
-    return AllocateBufferSafe<true>({mctx, rdata_alloc_}, size);
+    return AllocateBufferSafe<true>({mctx, rdata_alloc_},
+                                    header_->rdata_waitq_, size);
   }
 #endif
 
  private:
-  /** Allocate a buffer */
+  /** Try to allocate a buffer once */
+  HSHM_INLINE_CROSS_FUN FullPtr<char> TryAllocateBuffer(
+      const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, size_t size);
+
+  /** Allocate a buffer, waiting in FIFO order while memory is exhausted */
   template <bool FROM_REMOTE = false>
   HSHM_INLINE_CROSS_FUN FullPtr<char> AllocateBufferSafe(
-      const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, size_t size);
+      const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, AllocWaitQueue &waitq,
+      size_t size);
+
+  /** Get the wait queue of an allocator, if it has one */
+  HSHM_INLINE_CROSS_FUN
+  AllocWaitQueue *GetAllocWaitQueue(const hipc::AllocatorId &alloc_id) {
+    if (alloc_id == data_alloc_id_) {
+      return &header_->data_waitq_;
+    } else if (alloc_id == rdata_alloc_id_) {
+      return &header_->rdata_waitq_;
+    }
+    return nullptr;
+  }
 
  public:
   /** Free a buffer */
   HSHM_INLINE_CROSS_FUN
   void FreeBuffer(hipc::Pointer &p) {
-    auto alloc = HSHM_MEMORY_MANAGER->GetAllocator<CHI_ALLOC_T>(p.alloc_id_);
+    hipc::AllocatorId alloc_id = p.alloc_id_;
+    auto alloc = HSHM_MEMORY_MANAGER->GetAllocator<CHI_ALLOC_T>(alloc_id);
+    if (alloc_id == data_alloc_id_) {
+      FreeDataBuffer(HSHM_MEMORY_MANAGER->Convert<char>(p));
+      return;
+    }
     alloc->Free(hshm::ThreadId::GetNull(), p);
+    NotifyFree(alloc_id);
   }
 
   /** Free a buffer */
   HSHM_INLINE_CROSS_FUN
   void FreeBuffer(FullPtr<char> &p) {
-    auto alloc =
-        HSHM_MEMORY_MANAGER->GetAllocator<CHI_ALLOC_T>(p.shm_.alloc_id_);
+    hipc::AllocatorId alloc_id = p.shm_.alloc_id_;
+    if (alloc_id == data_alloc_id_) {
+      FreeDataBuffer(p.ptr_);
+      return;
+    }
+    auto alloc = HSHM_MEMORY_MANAGER->GetAllocator<CHI_ALLOC_T>(alloc_id);
     alloc->FreeLocalPtr(hshm::ThreadId::GetNull(), p);
+    NotifyFree(alloc_id);
+  }
+
+ private:
+  /**
+   * Free a buffer returned by AllocateBuffer. AllocateBuffer is the only
+   * way to get memory from data_alloc_, so every buffer it owns carries
+   * a SlabHeader. A missing magic means a foreign or double-freed pointer.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  void FreeDataBuffer(char *data) {
+    SlabHeader *hdr = GetSlabHeader(data);
+    if (hdr->magic_ != CHI_SLAB_MAGIC) {
+      HELOG(kFatal, "Buffer {} was not allocated by AllocateBuffer",
+            (void *)data);
+      return;
+    }
+    hdr->magic_ = 0;
+    char *blk = reinterpret_cast<char *>(hdr);
+#ifdef HSHM_IS_HOST
+    if (hdr->slab_size_) {
+      data_slab_.Free(blk, hdr->slab_size_);
+      return;
+    }
+#endif
+    FullPtr<char> p;
+    p.ptr_ = blk;
+    p.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(blk);
+    data_alloc_->FreeLocalPtr(hshm::ThreadId::GetNull(), p);
+    NotifyFree(data_alloc_id_);
+  }
+
+ public:
+
+  /** Let threads waiting on an allocator retry */
+  HSHM_INLINE_CROSS_FUN
+  void NotifyFree(const hipc::AllocatorId &alloc_id) {
+#ifdef HSHM_IS_HOST
+    AllocWaitQueue *waitq = GetAllocWaitQueue(alloc_id);
+    if (waitq) {
+      waitq->Notify();
+    }
+#endif
+  }
+
+  /** Create a shared-memory region for RegisterBuffer (client-side) */
+  RegisteredBuffer CreateBuffer(const std::string &name, size_t size);
+
+#ifdef CHIMAERA_RUNTIME
+  /** Map a client's registered region into the runtime */
+  void AttachBuffer(const std::string &name);
+#endif
+
+  /** Allocate a task payload, inline if it fits */
+  template <size_t INLINE_SIZE>
+  HSHM_INLINE_CROSS_FUN void AllocateTaskData(const hipc::MemContext &mctx,
+                                              TaskData<INLINE_SIZE> &data,
+                                              size_t size) {
+    if (TaskData<INLINE_SIZE>::Fits(size)) {
+      data.SetInline(size);
+      return;
+    }
+    FullPtr<char> buf = AllocateBuffer(mctx, size);
+    data.SetExternal(buf.shm_, size);
+  }
+
+  /** Free a task payload allocated by AllocateTaskData */
+  template <size_t INLINE_SIZE>
+  HSHM_INLINE_CROSS_FUN void FreeTaskData(TaskData<INLINE_SIZE> &data) {
+    if (!data.IsInline()) {
+      FreeBuffer(data.ext_);
+      data.SetInline(0);
+    }
   }
 
   /** Convert pointer to char* */
@@ -311,6 +595,83 @@ class Client : public ConfigurationManager {
   HSHM_INLINE_CROSS_FUN void ScheduleTask(Task *parent_task,
                                           const FullPtr<TaskT> &task);
 
+  /** Choose the ingress lane hash for a task */
+  template <typename TaskT>
+  HSHM_INLINE_CROSS_FUN u32 GetIngressLaneHash(ingress::MultiQueue *queue,
+                                               const FullPtr<TaskT> &task);
+
+  /**
+   * Send a batch of constructed tasks to the runtime.
+   * The batch is placed in the lane of the first task and spills to the
+   * next lane with room when that lane fills. Lanes only pick the
+   * ingesting worker; each task is still routed by its own dom_query, so
+   * batches may mix domains, but same-domain batches avoid a reroute.
+   * */
+  template <typename TaskT>
+  HSHM_INLINE_CROSS_FUN void ScheduleTasks(Task *parent_task,
+                                           const FullPtr<TaskT> *tasks,
+                                           size_t count);
+
+  /**
+   * Make \a child start only after \a parent completes. Both tasks must be
+   * unscheduled. If \a pass_output is set, \a child can read \a parent
+   * through GetDagInput(), so \a parent must not be fire & forget.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  void AddDependency(const hipc::MemContext &mctx, const FullPtr<Task> &parent,
+                     const FullPtr<Task> &child, bool pass_output = false) {
+    if (pass_output && parent->IsFireAndForget()) {
+      HELOG(kError, "A fire & forget task cannot pass its output");
+      pass_output = false;
+    }
+    TaskLinks &parent_links = GetOrCreateLinks(mctx, parent.ptr_);
+    TaskLinks &child_links = GetOrCreateLinks(mctx, child.ptr_);
+    FullPtr<DagEdge> edge = main_alloc_->NewObjLocal<DagEdge>(mctx);
+    edge->child_ = child.shm_;
+    edge->next_ = parent_links.dag_edges_;
+    edge->pass_output_ = pass_output;
+    parent_links.dag_edges_ = edge.shm_;
+    child_links.dag_deps_ += 1;
+  }
+
+  /** Get the DAG and group links of an unscheduled task, allocating them */
+  HSHM_INLINE_CROSS_FUN
+  TaskLinks &GetOrCreateLinks(const hipc::MemContext &mctx, Task *task) {
+    if (task->links_.IsNull()) {
+      FullPtr<TaskLinks> links = main_alloc_->NewObjLocal<TaskLinks>(mctx);
+      if (links.shm_.IsNull()) {
+        HELOG(kFatal, "Could not allocate the links of task {}",
+              (void *)task);
+      }
+      task->links_ = links.shm_;
+    }
+    return *task->GetLinks();
+  }
+
+  /**
+   * Submit a task DAG built with AddDependency. Only the roots are sent;
+   * the runtime starts the remaining tasks as their predecessors complete.
+   * */
+  template <typename TaskT>
+  HSHM_INLINE void ScheduleDag(Task *parent_task, const FullPtr<TaskT> *tasks,
+                               size_t count);
+
+  /**
+   * Submit tasks as a group. The group runs on one worker, in order, and
+   * completes as a unit: only tasks[0] is notified (SetComplete, waiter,
+   * completion queue), once every task of the group has ended. All tasks
+   * must target the same pool and must not be fire & forget.
+   * */
+  template <typename TaskT>
+  HSHM_INLINE_CROSS_FUN void ScheduleGroup(Task *parent_task,
+                                           const FullPtr<TaskT> *tasks,
+                                           size_t count);
+
+#ifdef CHIMAERA_RUNTIME
+  /** Start the DAG successors of a completed task (runtime-only) */
+  HSHM_INLINE void ReleaseDagEdges(const FullPtr<Task> &task);
+#endif
+
   /** Allocate + send a task to the runtime */
   template <typename TaskT, typename... Args>
   HSHM_INLINE_CROSS_FUN hipc::FullPtr<TaskT> ScheduleNewTask(
@@ -347,6 +708,11 @@ class Client : public ConfigurationManager {
       const chi::TaskNode &task_node, Args &&...args) {                   \
     return CHI_CLIENT->ScheduleNewTask<CUSTOM##Task>(                     \
         mctx, parent, task_node, id_, std::forward<Args>(args)...);       \
+  }                                                                       \
+                                                                          \
+  HSHM_CROSS_FUN void Async##CUSTOM##Batch(                               \
+      hipc::FullPtr<CUSTOM##Task> *tasks, size_t count) {                 \
+    CHI_CLIENT->ScheduleTasks<CUSTOM##Task>(nullptr, tasks, count);       \
   }
 
 /** Call duplicate if applicable */
@@ -356,6 +722,23 @@ constexpr inline void CALL_COPY_START(const TaskT *orig_task, TaskT *dup_task,
   return CHI_CLIENT->CopyTask(orig_task, dup_task, deep);
 }
 
+/** Call merge if applicable */
+template <typename TaskT>
+constexpr inline bool CALL_MERGE(TaskT *task, const TaskT *next) {
+  if constexpr (TaskT::MERGE) {
+    return task->Merge(*next);
+  }
+  return false;
+}
+
+/** Call merge end if applicable */
+template <typename TaskT>
+constexpr inline void CALL_MERGE_END(const TaskT *task, TaskT *merged) {
+  if constexpr (TaskT::MERGE) {
+    merged->MergeEnd(*task);
+  }
+}
+
 /** Call duplicate if applicable */
 template <typename TaskT>
 constexpr inline void CALL_NEW_COPY_START(const TaskT *orig_task,
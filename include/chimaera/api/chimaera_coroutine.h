@@ -0,0 +1,267 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Distributed under BSD 3-Clause license.                                   *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Illinois Institute of Technology.                        *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of Hermes. The full Hermes copyright notice, including  *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the top directory. If you do not  *
+ * have access to the file, you may request a copy from help@hdfgroup.org.   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHI_INCLUDE_CHI_API_CHIMAERA_COROUTINE_H_
+#define CHI_INCLUDE_CHI_API_CHIMAERA_COROUTINE_H_
+
+#ifdef CHIMAERA_ENABLE_COROUTINES
+
+#if __cplusplus < 202002L
+#error "CHIMAERA_ENABLE_COROUTINES requires C++20"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chimaera/api/chimaera_client.h"
+
+namespace chi {
+
+/**
+ * Resumes client coroutines once the tasks they await complete.
+ * One loop per thread. Coroutines are resumed on the thread that polls.
+ * */
+class CoEventLoop {
+ public:
+  /** A coroutine suspended on a task */
+  struct Waiter {
+    Task *task_;
+    std::coroutine_handle<> handle_;
+  };
+  std::vector<Waiter> waiters_; /**< Suspended coroutines */
+  std::vector<Waiter> ready_;   /**< Coroutines to resume this poll */
+
+ public:
+  /** Get this thread's event loop */
+  static CoEventLoop &Get() {
+    static thread_local CoEventLoop loop;
+    return loop;
+  }
+
+  /** Suspend \a handle until \a task completes */
+  void Register(Task *task, std::coroutine_handle<> handle) {
+    waiters_.emplace_back(Waiter{task, handle});
+  }
+
+  /** Whether any coroutine is suspended */
+  bool IsEmpty() const { return waiters_.empty(); }
+
+  /** Resume coroutines whose tasks completed. Returns # resumed. */
+  size_t Poll() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 0; i < waiters_.size();) {
+      if (waiters_[i].task_->IsComplete()) {
+        ready_.emplace_back(waiters_[i]);
+        waiters_[i] = waiters_.back();
+        waiters_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+    // Resumed coroutines may register new waiters or poll again
+    std::vector<Waiter> ready;
+    ready.swap(ready_);
+    for (Waiter &waiter : ready) {
+      waiter.handle_.resume();
+    }
+    size_t count = ready.size();
+    ready.clear();
+    if (ready_.empty()) {
+      ready_.swap(ready);
+    }
+    return count;
+  }
+
+  /** Poll until no coroutine is suspended */
+  void Run() {
+    while (!IsEmpty()) {
+      if (Poll() == 0) {
+        Task::YieldStd();
+      }
+    }
+  }
+};
+
+/** Awaits the completion of a task */
+template <typename TaskT>
+struct TaskAwaiter {
+  FullPtr<TaskT> task_;
+
+  /** Skip suspension if the task already completed */
+  bool await_ready() const noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return task_->IsComplete();
+  }
+
+  /** Park the coroutine in this thread's event loop */
+  void await_suspend(std::coroutine_handle<> handle) {
+    CoEventLoop::Get().Register(task_.ptr_, handle);
+  }
+
+  /** The completed task. The caller still owns it. */
+  FullPtr<TaskT> await_resume() noexcept { return task_; }
+};
+
+/** Allow co_await on the result of an Async* client call */
+template <typename TaskT>
+  requires std::is_base_of_v<Task, TaskT>
+TaskAwaiter<TaskT> operator co_await(FullPtr<TaskT> task) {
+  return TaskAwaiter<TaskT>{task};
+}
+
+template <typename T>
+class CoTask;
+
+/** Promise state shared by all CoTask results */
+struct CoPromiseBase {
+  std::coroutine_handle<> cont_;  /**< Coroutine awaiting this one */
+  std::exception_ptr error_;      /**< Exception escaping the body */
+
+  /** Start eagerly, so the first request is submitted immediately */
+  std::suspend_never initial_suspend() noexcept { return {}; }
+
+  /** Resume the awaiting coroutine, if any */
+  auto final_suspend() noexcept {
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      template <typename PromiseT>
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<PromiseT> handle) noexcept {
+        std::coroutine_handle<> cont = handle.promise().cont_;
+        return cont ? cont : std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+    return FinalAwaiter{};
+  }
+
+  void unhandled_exception() { error_ = std::current_exception(); }
+};
+
+/** Promise holding a result */
+template <typename T>
+struct CoPromise : public CoPromiseBase {
+  std::optional<T> value_;
+
+  CoTask<T> get_return_object();
+  void return_value(T value) { value_.emplace(std::move(value)); }
+};
+
+/** Promise without a result */
+template <>
+struct CoPromise<void> : public CoPromiseBase {
+  CoTask<void> get_return_object();
+  void return_void() {}
+};
+
+/**
+ * An application coroutine that awaits chimaera tasks.
+ * CoTasks can await each other and are driven by CoEventLoop.
+ * */
+template <typename T = void>
+class CoTask {
+ public:
+  typedef CoPromise<T> promise_type;
+  std::coroutine_handle<promise_type> handle_;
+
+ public:
+  /** Emplace constructor */
+  explicit CoTask(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  /** Move constructor */
+  CoTask(CoTask &&other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  /** Move assignment operator */
+  CoTask &operator=(CoTask &&other) noexcept {
+    if (this != &other) {
+      Destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  CoTask(const CoTask &) = delete;
+  CoTask &operator=(const CoTask &) = delete;
+
+  /** Destructor */
+  ~CoTask() { Destroy(); }
+
+  /** Whether the coroutine ran to completion */
+  bool IsDone() const { return handle_.done(); }
+
+  /** Get the result. Rethrows an exception escaping the body. */
+  T GetResult() {
+    promise_type &promise = handle_.promise();
+    if (promise.error_) {
+      std::rethrow_exception(promise.error_);
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return std::move(*promise.value_);
+    }
+  }
+
+  /** Await another CoTask */
+  bool await_ready() const noexcept { return IsDone(); }
+  void await_suspend(std::coroutine_handle<> cont) noexcept {
+    handle_.promise().cont_ = cont;
+  }
+  T await_resume() { return GetResult(); }
+
+ private:
+  void Destroy() {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+};
+
+template <typename T>
+CoTask<T> CoPromise<T>::get_return_object() {
+  return CoTask<T>(std::coroutine_handle<CoPromise<T>>::from_promise(*this));
+}
+
+inline CoTask<void> CoPromise<void>::get_return_object() {
+  return CoTask<void>(
+      std::coroutine_handle<CoPromise<void>>::from_promise(*this));
+}
+
+/** Drive this thread's event loop until \a task completes */
+template <typename T>
+T CoRun(CoTask<T> &task) {
+  CoEventLoop &loop = CoEventLoop::Get();
+  while (!task.IsDone()) {
+    if (loop.Poll() == 0) {
+      Task::YieldStd();
+    }
+  }
+  return task.GetResult();
+}
+
+/** Drive this thread's event loop until \a task completes */
+template <typename T>
+T CoRun(CoTask<T> &&task) {
+  return CoRun(task);
+}
+
+}  // namespace chi
+
+#endif  // CHIMAERA_ENABLE_COROUTINES
+
+#endif  // CHI_INCLUDE_CHI_API_CHIMAERA_COROUTINE_H_
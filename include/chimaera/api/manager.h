@@ -18,6 +18,9 @@
 #include "chimaera/config/config_client.h"
 #include "chimaera/config/config_server.h"
 #include "chimaera/queue_manager/queue_manager.h"
+#include "alloc_wait_queue.h"
+#include "route_table.h"
+#include "task_slab.h"
 
 namespace chi {
 
@@ -27,9 +30,19 @@ struct ChiShm {
   QueueManagerShm queue_manager_;
   hipc::atomic<hshm::min_u64> unique_;
   u64 num_nodes_;
+  TaskSlabShm task_slab_;
+  hipc::atomic<u32> buffer_count_; /**< # of registered client buffers */
+  AllocWaitQueue data_waitq_;      /**< Waiters on the data allocator */
+  AllocWaitQueue rdata_waitq_;     /**< Waiters on the rdata allocator */
+  hipc::atomic<u64> pool_gen_;     /**< Bumped when pools or domains change */
+  RouteTable route_table_;         /**< Worker of each (pool, domain query) */
+  hipc::Pointer data_slab_;        /**< TaskSlabShm of small data buffers */
+  hipc::atomic<hshm::min_u64> pool_unique_; /**< Dense pool id counter */
 };
 
 #define MAX_GPU 16
+/** Max # of client buffers registered with the runtime */
+#define CHI_MAX_BUFFERS 32
 
 /** The configuration used inherited by runtime + client */
 class ConfigurationManager {
@@ -76,6 +89,17 @@ class ConfigurationManager {
     return hipc::AllocatorId(3 + gpu_id, 0);
   }
 
+  /** Get registered buffer mem backend id */
+  HSHM_INLINE_CROSS_FUN static hipc::MemoryBackendId GetBufferMemBackendId(
+      u32 buf_id) {
+    return hipc::MemoryBackendId(3 + MAX_GPU + buf_id);
+  }
+
+  /** Get registered buffer allocator id */
+  HSHM_INLINE_CROSS_FUN static hipc::AllocatorId GetBufferAllocId(u32 buf_id) {
+    return hipc::AllocatorId(3 + MAX_GPU + buf_id, 0);
+  }
+
   /** Get GPU allocator */
   HSHM_INLINE_CROSS_FUN CHI_ALLOC_T *GetGpuAlloc(int gpu_id) {
     return gpu_alloc_[gpu_id];
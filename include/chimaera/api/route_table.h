@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Distributed under BSD 3-Clause license.                                   *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Illinois Institute of Technology.                        *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of Hermes. The full Hermes copyright notice, including  *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the top directory. If you do not  *
+ * have access to the file, you may request a copy from help@hdfgroup.org.   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHI_INCLUDE_CHI_API_ROUTE_TABLE_H_
+#define CHI_INCLUDE_CHI_API_ROUTE_TABLE_H_
+
+#include <atomic>
+
+#include "chimaera/chimaera_types.h"
+
+namespace chi {
+
+/** Number of (pool, domain query) route hints (power of two) */
+#define CHI_ROUTE_HINTS 1024
+/** Max number of workers whose ingress lanes are published */
+#define CHI_MAX_ROUTE_WORKERS 256
+
+/**
+ * Route hints published by the runtime in shared memory.
+ * Container lanes are private to the runtime, so clients cannot push to
+ * them. Instead, workers record which worker ran the tasks of a
+ * (pool, domain query), and clients submit new tasks to an ingress lane
+ * owned by that worker. The ingesting worker then routes the task to its
+ * own lane instead of handing it to another worker. Hints are advisory:
+ * a stale or torn entry only costs the usual worker hop.
+ * */
+struct RouteTable {
+  std::atomic<u64> keys_[CHI_ROUTE_HINTS];    /**< Route key of each hint */
+  std::atomic<u32> workers_[CHI_ROUTE_HINTS]; /**< Worker of each hint */
+  std::atomic<u32> worker_lanes_[CHI_MAX_ROUTE_WORKERS]; /**< Lane id + 1 */
+
+  /** Initialize the table (runtime only) */
+  void shm_init() {
+    for (u32 i = 0; i < CHI_ROUTE_HINTS; ++i) {
+      keys_[i] = 0;
+      workers_[i] = 0;
+    }
+    for (u32 i = 0; i < CHI_MAX_ROUTE_WORKERS; ++i) {
+      worker_lanes_[i] = 0;
+    }
+  }
+
+  /** Get the route key of a task. Never 0. */
+  HSHM_INLINE_CROSS_FUN
+  static u64 GetKey(const PoolId &pool, const DomainQuery &dom_query) {
+    return (pool.Hash() * 31 + hshm::hash<DomainQuery>{}(dom_query)) | 1;
+  }
+
+  /** Record that tasks of \a key run on \a worker_id */
+  HSHM_INLINE_CROSS_FUN
+  void Publish(u64 key, WorkerId worker_id) {
+    u32 slot = key & (CHI_ROUTE_HINTS - 1);
+    // Avoid dirtying the cache line when nothing changed
+    if (keys_[slot].load(std::memory_order_relaxed) == key &&
+        workers_[slot].load(std::memory_order_relaxed) == worker_id) {
+      return;
+    }
+    workers_[slot].store(worker_id, std::memory_order_relaxed);
+    keys_[slot].store(key, std::memory_order_release);
+  }
+
+  /** Publish the process-queue lane polled by \a worker_id */
+  void SetWorkerLane(WorkerId worker_id, LaneId lane_id) {
+    if (worker_id >= CHI_MAX_ROUTE_WORKERS) {
+      return;
+    }
+    u32 unset = 0;
+    worker_lanes_[worker_id].compare_exchange_strong(unset, lane_id + 1);
+  }
+
+  /** Find the ingress lane of the worker that runs tasks of \a key */
+  HSHM_INLINE_CROSS_FUN
+  bool Find(u64 key, u32 &lane_id) {
+    u32 slot = key & (CHI_ROUTE_HINTS - 1);
+    if (keys_[slot].load(std::memory_order_acquire) != key) {
+      return false;
+    }
+    u32 worker_id = workers_[slot].load(std::memory_order_relaxed);
+    if (worker_id >= CHI_MAX_ROUTE_WORKERS) {
+      return false;
+    }
+    u32 lane = worker_lanes_[worker_id].load(std::memory_order_relaxed);
+    if (lane == 0) {
+      return false;
+    }
+    lane_id = lane - 1;
+    return true;
+  }
+};
+
+/**
+ * The route hints one worker last published (runtime-private). Workers
+ * check it before touching the shared table, so the table is only
+ * accessed when the owner of a hint changes.
+ * */
+struct RouteHintCache {
+  u64 keys_[CHI_ROUTE_HINTS] = {};         /**< Route key of each hint */
+  WorkerId workers_[CHI_ROUTE_HINTS] = {}; /**< Worker of each hint */
+
+  /** Record that \a key runs on \a worker_id. True if this changed. */
+  bool Update(u64 key, WorkerId worker_id) {
+    u32 slot = key & (CHI_ROUTE_HINTS - 1);
+    if (keys_[slot] == key && workers_[slot] == worker_id) {
+      return false;
+    }
+    keys_[slot] = key;
+    workers_[slot] = worker_id;
+    return true;
+  }
+};
+
+}  // namespace chi
+
+#endif  // CHI_INCLUDE_CHI_API_ROUTE_TABLE_H_
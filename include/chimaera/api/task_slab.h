@@ -0,0 +1,284 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Distributed under BSD 3-Clause license.                                   *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Illinois Institute of Technology.                        *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of Hermes. The full Hermes copyright notice, including  *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the top directory. If you do not  *
+ * have access to the file, you may request a copy from help@hdfgroup.org.   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHI_INCLUDE_CHI_API_TASK_SLAB_H_
+#define CHI_INCLUDE_CHI_API_TASK_SLAB_H_
+
+#include <atomic>
+#include <vector>
+
+#include "chimaera/api/alloc_wait_queue.h"
+#include "chimaera/chimaera_types.h"
+
+namespace chi {
+
+/** Granularity of slab size classes (bytes) */
+#define CHI_SLAB_GRAN 64
+/** Number of slab size classes. Larger tasks use the main allocator. */
+#define CHI_SLAB_NUM_CLASSES 64
+/** Number of blocks carved from the main allocator per refill */
+#define CHI_SLAB_REFILL 64
+/** Max blocks kept in a thread's front cache per size class */
+#define CHI_SLAB_CACHE 256
+/** Max number of slabs per process (tasks, data buffers) */
+#define CHI_SLAB_MAX_SLABS 4
+/** Max blocks kept on a shared free list. Extra blocks go to the allocator. */
+#define CHI_SLAB_SHARED_MAX 1024
+/** Marks a block allocated with a SlabHeader */
+#define CHI_SLAB_MAGIC 0x434849534c414221ull
+
+/**
+ * Precedes every task block and data buffer handed out by the client,
+ * so frees recover the block's size class from the block itself rather
+ * than from the static type or a size passed by the caller.
+ * */
+struct SlabHeader {
+  u64 magic_;     /**< CHI_SLAB_MAGIC while the block is allocated */
+  u64 slab_size_; /**< Slab block size, or 0 if from the allocator */
+};
+
+/**
+ * Shared-memory free lists of task blocks, one per size class.
+ * Each head is a tagged (16-bit ABA tag, 48-bit offset) Treiber stack.
+ * Offsets are relative to this struct, which lives in the same region as
+ * the blocks, so they are valid in every process.
+ * */
+struct TaskSlabShm {
+  std::atomic<u64> heads_[CHI_SLAB_NUM_CLASSES];
+  std::atomic<u64> counts_[CHI_SLAB_NUM_CLASSES]; /**< Approximate lengths */
+
+  /** Initialize the free lists (runtime only) */
+  void shm_init() {
+    for (u32 i = 0; i < CHI_SLAB_NUM_CLASSES; ++i) {
+      heads_[i] = 0;
+      counts_[i] = 0;
+    }
+  }
+};
+
+class TaskSlab;
+
+/** A thread's front cache of free blocks */
+struct TaskSlabCache {
+  TaskSlab *slab_ = nullptr;
+  std::vector<char *> blocks_[CHI_SLAB_NUM_CLASSES];
+
+  /** Return cached blocks to shared memory on thread exit */
+  ~TaskSlabCache();
+};
+
+/**
+ * Per-size-class slab pools in shared memory, used for tasks and small
+ * data buffers. Blocks are allocated from an allocator in batches.
+ * Allocation is a pop from the thread's front cache. Frees from any
+ * process (e.g., the runtime freeing a client's task) go to the freeing
+ * thread's cache and spill to the lock-free shared free list. Once a
+ * shared list holds CHI_SLAB_SHARED_MAX blocks, spilled blocks are
+ * returned to the allocator, so the slab does not pin its high-water mark.
+ * */
+class TaskSlab {
+ public:
+  CHI_ALLOC_T *alloc_ = nullptr;
+  TaskSlabShm *shm_ = nullptr;
+  u32 id_ = 0; /**< Index of this slab's thread caches */
+  AllocWaitQueue *waitq_ = nullptr; /**< Notified when blocks are returned */
+  CLS_CONST u64 kOffBits = 48;
+  CLS_CONST u64 kOffMask = (((u64)1) << kOffBits) - 1;
+
+ public:
+  /**
+   * Attach to the shared free lists. \a shm must be in the same region as
+   * the blocks of \a alloc. \a id is unique per slab in the process.
+   * \a waitq, if any, is notified when blocks go back to \a alloc.
+   * */
+  void Init(CHI_ALLOC_T *alloc, TaskSlabShm *shm, u32 id,
+            AllocWaitQueue *waitq = nullptr) {
+    alloc_ = alloc;
+    shm_ = shm;
+    id_ = id;
+    waitq_ = waitq;
+  }
+
+  /** Get the size class of a task */
+  HSHM_INLINE_CROSS_FUN
+  static constexpr u32 GetClass(size_t size) {
+    return (u32)((size + CHI_SLAB_GRAN - 1) / CHI_SLAB_GRAN - 1);
+  }
+
+  /** Whether a task of \a size is served by the slab */
+  HSHM_INLINE_CROSS_FUN
+  bool IsSlabSize(size_t size) const {
+#ifdef HSHM_IS_HOST
+    return shm_ != nullptr && GetClass(size) < CHI_SLAB_NUM_CLASSES;
+#else
+    return false;
+#endif
+  }
+
+  /** Allocate a block for a task of \a size */
+  FullPtr<char> Allocate(const hipc::MemContext &mctx, size_t size) {
+    u32 cls = GetClass(size);
+    std::vector<char *> &cache = GetCache().blocks_[cls];
+    if (cache.empty()) {
+      Refill(mctx, cls, cache);
+    }
+    FullPtr<char> p;
+    if (cache.empty()) {
+      return p;
+    }
+    p.ptr_ = cache.back();
+    cache.pop_back();
+    p.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(p.ptr_);
+    return p;
+  }
+
+  /** Free a block for a task of \a size */
+  void Free(char *blk, size_t size) {
+    // Allocations are waiting for memory, so give the block back now
+    if (waitq_ && waitq_->HasWaiters()) {
+      FreeToAlloc(blk);
+      return;
+    }
+    u32 cls = GetClass(size);
+    std::vector<char *> &cache = GetCache().blocks_[cls];
+    cache.push_back(blk);
+    if (cache.size() > CHI_SLAB_CACHE) {
+      // Return half of the cache to shared memory
+      while (cache.size() > CHI_SLAB_CACHE / 2) {
+        Release(cls, cache.back());
+        cache.pop_back();
+      }
+    }
+  }
+
+  /** Return all blocks of a front cache to shared memory */
+  void Flush(TaskSlabCache &cache) {
+    for (u32 cls = 0; cls < CHI_SLAB_NUM_CLASSES; ++cls) {
+      for (char *blk : cache.blocks_[cls]) {
+        Release(cls, blk);
+      }
+      cache.blocks_[cls].clear();
+    }
+  }
+
+ private:
+  /** Get this thread's front cache */
+  TaskSlabCache &GetCache() {
+    static thread_local TaskSlabCache caches[CHI_SLAB_MAX_SLABS];
+    TaskSlabCache &cache = caches[id_];
+    cache.slab_ = this;
+    return cache;
+  }
+
+  /** Pull blocks from shared memory, or allocate a new batch */
+  void Refill(const hipc::MemContext &mctx, u32 cls,
+              std::vector<char *> &cache) {
+    for (u32 i = 0; i < CHI_SLAB_REFILL; ++i) {
+      char *blk = Pop(cls);
+      if (!blk) {
+        break;
+      }
+      cache.push_back(blk);
+    }
+    if (!cache.empty()) {
+      return;
+    }
+    // Blocks are allocated one by one so each can be returned on its own
+    size_t blk_size = (cls + 1) * CHI_SLAB_GRAN;
+    for (u32 i = 0; i < CHI_SLAB_REFILL; ++i) {
+      FullPtr<char> blk = alloc_->AllocateLocalPtr<char>(mctx, blk_size);
+      if (blk.shm_.IsNull()) {
+        break;
+      }
+      cache.push_back(blk.ptr_);
+    }
+  }
+
+  /** Spill a block to the shared free list, or to the allocator if full */
+  void Release(u32 cls, char *blk) {
+    if (shm_->counts_[cls].load(std::memory_order_relaxed) <
+        CHI_SLAB_SHARED_MAX) {
+      Push(cls, blk);
+      return;
+    }
+    FreeToAlloc(blk);
+  }
+
+  /** Return a block to the allocator */
+  void FreeToAlloc(char *blk) {
+    FullPtr<char> p;
+    p.ptr_ = blk;
+    p.shm_ = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(blk);
+    alloc_->FreeLocalPtr(hshm::ThreadId::GetNull(), p);
+    if (waitq_) {
+      waitq_->Notify();
+    }
+  }
+
+  /** Encode a block as an offset relative to shm_ */
+  u64 Encode(char *blk) {
+    return (u64)(blk - reinterpret_cast<char *>(shm_)) & kOffMask;
+  }
+
+  /** Decode an offset relative to shm_ */
+  char *Decode(u64 off) {
+    // Sign-extend the 48-bit offset
+    i64 soff = (i64)(off << (64 - kOffBits)) >> (64 - kOffBits);
+    return reinterpret_cast<char *>(shm_) + soff;
+  }
+
+  /** Push a block to the shared free list */
+  void Push(u32 cls, char *blk) {
+    std::atomic<u64> &head = shm_->heads_[cls];
+    u64 old_head = head.load();
+    while (true) {
+      *reinterpret_cast<u64 *>(blk) = old_head & kOffMask;
+      u64 tag = (old_head >> kOffBits) + 1;
+      u64 new_head = (tag << kOffBits) | Encode(blk);
+      if (head.compare_exchange_weak(old_head, new_head)) {
+        shm_->counts_[cls].fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+  /** Pop a block from the shared free list */
+  char *Pop(u32 cls) {
+    std::atomic<u64> &head = shm_->heads_[cls];
+    u64 old_head = head.load();
+    while (true) {
+      u64 off = old_head & kOffMask;
+      if (off == 0) {
+        return nullptr;
+      }
+      char *blk = Decode(off);
+      u64 next = *reinterpret_cast<u64 *>(blk);
+      u64 tag = (old_head >> kOffBits) + 1;
+      u64 new_head = (tag << kOffBits) | next;
+      if (head.compare_exchange_weak(old_head, new_head)) {
+        shm_->counts_[cls].fetch_sub(1, std::memory_order_relaxed);
+        return blk;
+      }
+    }
+  }
+};
+
+/** Return cached blocks to shared memory on thread exit */
+inline TaskSlabCache::~TaskSlabCache() {
+  if (slab_ && slab_->shm_) {
+    slab_->Flush(*this);
+  }
+}
+
+}  // namespace chi
+
+#endif  // CHI_INCLUDE_CHI_API_TASK_SLAB_H_
@@ -61,6 +61,8 @@ HSHM_DATA_STRUCTURES_TEMPLATE(chi, CHI_ALLOC_T);
 namespace chi {
 
 #define CHI_LANE_SIZE 8192
+/** Used to keep concurrently-written fields on separate cache lines */
+#define CHI_CACHE_LINE_SIZE 64
 
 using hshm::bitfield;
 using hshm::bitfield16_t;
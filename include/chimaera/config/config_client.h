@@ -27,6 +27,8 @@ class ClientConfig : public BaseConfig {
  public:
   /** The thread model of the application */
   std::string thread_model_;
+  /** How client threads pick ingress lanes: kHash, kThreadAffine or kRouted */
+  std::string lane_policy_;
 
  private:
   void ParseYAML(YAML::Node &yaml_conf) override;
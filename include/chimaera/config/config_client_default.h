@@ -1,5 +1,7 @@
 #ifndef CHI_SRC_CONFIG_CHI_CLIENT_DEFAULT_H_
 #define CHI_SRC_CONFIG_CHI_CLIENT_DEFAULT_H_
 const inline char* kChiDefaultClientConfigStr = 
-"thread_model: kStd\n";
+"thread_model: kStd\n"
+"# How client threads pick ingress lanes: kHash, kThreadAffine or kRouted\n"
+"lane_policy: kHash\n";
 #endif  // CHI_SRC_CONFIG_CHI_CLIENT_DEFAULT_H_
\ No newline at end of file
@@ -42,6 +42,8 @@ struct QueueManagerInfo {
   u32 proc_queue_depth_;
   /** Maximum number of lanes per IPC queue */
   u32 max_containers_pn_;
+  /** Number of lanes active at boot; ResizeQueue grows up to the max */
+  u32 num_lanes_;
   /** Maximum number of allocatable IPC queues */
   u32 max_queues_;
   /** Shared memory region name */
@@ -20,6 +20,8 @@ const inline char* kChiServerDefaultConfigStr =
     "  queue_depth: 100000\n"
     "  # The maximum number of lanes per queue\n"
     "  max_lanes: 16\n"
+    "  # The number of lanes active at boot (grown with ResizeQueue)\n"
+    "  num_lanes: 4\n"
     "  # The maximum number of queues\n"
     "  max_queues: 1024\n"
     "  # The name of the shared memory region to create\n"
@@ -15,6 +15,11 @@
 
 #include <dlfcn.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "chimaera/chimaera_types.h"
 #include "chimaera/network/serialize_defn.h"
 #include "chimaera/queue_manager/queue.h"
@@ -26,21 +31,26 @@ namespace chi {
 
 typedef FullPtr<Task> TaskPointer;
 
-/** The information of a lane */
+/**
+ * The information of a lane.
+ * Read-mostly metadata comes first. The task counter (written by every
+ * pusher), the load (written by the owning worker, read by schedulers),
+ * the task queue and the mutex each get their own cache line.
+ * */
 class Lane : public hipc::list_queue_entry {
  public:
   LaneId lane_id_;
   TaskPrio prio_;
   LaneGroupId group_id_;
   WorkerId worker_id_;
-  Load load_;
-  CoMutex comux_;
-  hipc::atomic<hshm::min_u64> plug_count_;
   size_t lane_req_;
+  hipc::atomic<hshm::min_u64> plug_count_;
+  alignas(CHI_CACHE_LINE_SIZE) hipc::atomic<hshm::min_u64> count_;
+  alignas(CHI_CACHE_LINE_SIZE) Load load_;
   // TODO(llogan): This doesn't preserve task order
   // chi::mpsc_lifo_list_queue<Task> active_tasks_;
-  chi::mpsc_queue<TaskPointer> active_tasks_;
-  hipc::atomic<hshm::min_u64> count_;
+  alignas(CHI_CACHE_LINE_SIZE) chi::mpsc_queue<TaskPointer> active_tasks_;
+  alignas(CHI_CACHE_LINE_SIZE) CoMutex comux_;
 
  public:
   /** Default constructor */
@@ -117,6 +127,98 @@ struct LaneGroup {
   size_t size() { return lanes_[0].size(); }
 };
 
+/**
+ * Quiesce state of a container, shared by its versions across upgrades.
+ * While active, new tasks for the container are parked instead of routed.
+ * Tasks already routed keep running and are counted until they end, so
+ * the container can be swapped once the count drains to zero.
+ * Long-running tasks never end, so only their individual runs are counted
+ * and new runs are held back while the container is quiesced.
+ * */
+struct ContainerQuiesce {
+  std::atomic<bool> active_{false};   /**< New tasks are parked */
+  std::atomic<u64> in_flight_{0};     /**< Routed tasks not yet ended */
+  std::atomic<u64> version_{0};       /**< # of times the container swapped */
+  std::mutex lock_;                   /**< Protects parked_ */
+  std::vector<FullPtr<Task>> parked_; /**< Tasks to replay after quiesce */
+
+  /**
+   * Admit a task being routed to the container. Returns false if the task
+   * was parked instead. Subtasks awaited by a task in flight on this
+   * container are never parked, since the drain would wait on them.
+   * */
+  bool Admit(const FullPtr<Task> &task) {
+    bool counted = !task->IsLongRunning();
+    if (counted) {
+      in_flight_.fetch_add(1);
+    }
+    if (!active_.load() || IsAwaitedHere(task.ptr_)) {
+      return true;
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!active_.load()) {
+      return true;
+    }
+    parked_.emplace_back(task);
+    if (counted) {
+      in_flight_.fetch_sub(1);
+    }
+    return false;
+  }
+
+  /** Whether a task is awaited by a task in flight on this container */
+  bool IsAwaitedHere(Task *task) const {
+    if (!task->rctx_ || !task->rctx_->pending_to_) {
+      return false;
+    }
+    Task *parent = task->rctx_->pending_to_;
+    return parent->rctx_ && parent->rctx_->quiesce_ == this;
+  }
+
+  /** Start one run of a long-running task. Returns false while quiesced. */
+  bool EnterRun() {
+    in_flight_.fetch_add(1);
+    if (!active_.load()) {
+      return true;
+    }
+    in_flight_.fetch_sub(1);
+    return false;
+  }
+
+  /** Undo the admission of a task that will be routed again */
+  void Revoke(const FullPtr<Task> &task) {
+    if (!task->IsLongRunning()) {
+      in_flight_.fetch_sub(1);
+    }
+  }
+
+  /** Count a task admitted with its group leader */
+  void AdmitMember(const FullPtr<Task> &task) {
+    if (!task->IsLongRunning()) {
+      in_flight_.fetch_add(1);
+    }
+  }
+
+  /** An admitted task ended */
+  void Release() { in_flight_.fetch_sub(1); }
+
+  /** Start parking new tasks */
+  void Begin() { active_.store(true); }
+
+  /** Whether every admitted task ended */
+  bool IsDrained() const { return in_flight_.load() == 0; }
+
+  /** Stop parking. Returns the parked tasks, oldest first. */
+  std::vector<FullPtr<Task>> End() {
+    std::vector<FullPtr<Task>> parked;
+    std::lock_guard<std::mutex> guard(lock_);
+    version_.fetch_add(1);
+    active_.store(false);
+    parked.swap(parked_);
+    return parked;
+  }
+};
+
 /**
  * Represents a custom operation to perform.
  * Tasks are independent of Hermes.
@@ -130,9 +232,13 @@ class Module {
   std::vector<std::shared_ptr<LaneGroup>>
       lane_groups_; /**< The lanes of a pool */
   bool is_created_ = false;
+  std::vector<RunFun> run_table_; /**< Run entries indexed by method */
+  std::shared_ptr<ContainerQuiesce> quiesce_; /**< Shared across upgrades */
 
   /** Default constructor */
-  Module() : id_(PoolId::GetNull()) {}
+  Module()
+      : id_(PoolId::GetNull()),
+        quiesce_(std::make_shared<ContainerQuiesce>()) {}
 
   /** Emplace Constructor */
   void Init(const PoolId &id, const QueueId &queue_id,
@@ -188,6 +294,19 @@ class Module {
     }
   }
 
+  /** Register the direct-dispatch Run entry of a method */
+  void SetRunFun(u32 method, RunFun fun) {
+    if (method >= run_table_.size()) {
+      run_table_.resize(method + 1, nullptr);
+    }
+    run_table_[method] = fun;
+  }
+
+  /** Get the direct-dispatch Run entry of a method, or nullptr */
+  RunFun GetRunFun(u32 method) const {
+    return method < run_table_.size() ? run_table_[method] : nullptr;
+  }
+
   /** Get number of active tasks */
   size_t GetNumActiveTasks() {
     size_t num_active = 0;
@@ -208,6 +327,9 @@ class Module {
   /** Run a method of the task */
   virtual void Run(u32 method, Task *task, RunContext &rctx) = 0;
 
+  /** Build run_table_ */
+  virtual void InitRunTable() = 0;
+
   /** Monitor a method of the task */
   virtual void Monitor(MonitorModeId mode, u32 method, Task *task,
                        RunContext &rctx) = 0;
@@ -237,6 +359,18 @@ class Module {
   /** Deserialize a task when returning from remote queue */
   virtual void LoadEnd(u32 method, BinaryInputArchive<false> &ar,
                        Task *task) = 0;
+
+  /**
+   * Merge a queued task into the run headed by \a task. The head is
+   * passed for every candidate so it can track the extent of its run.
+   * Only modules with mergeable methods override this.
+   * */
+  virtual bool Merge(u32 method, Task *task, const Task *next) {
+    return false;
+  }
+
+  /** Copy the results of a task to a task merged into it */
+  virtual void MergeEnd(u32 method, const Task *task, Task *merged) {}
 };
 
 /** Represents a Module in action */
@@ -286,12 +420,14 @@ typedef const char *(*get_module_name_t)(void);
   void *alloc_state(const chi::PoolId *pool_id, const char *pool_name) {    \
     chi::Container *exec =                                                  \
         reinterpret_cast<chi::Container *>(new TYPE_UNWRAP(TRAIT_CLASS)()); \
+    exec->InitRunTable();                                                   \
     return exec;                                                            \
   }                                                                         \
   void *new_state(const chi::PoolId *pool_id, const char *pool_name) {      \
     chi::Container *exec =                                                  \
         reinterpret_cast<chi::Container *>(new TYPE_UNWRAP(TRAIT_CLASS)()); \
     exec->Init(*pool_id, CHI_CLIENT->GetQueueId(*pool_id), pool_name);      \
+    exec->InitRunTable();                                                   \
     return exec;                                                            \
   }                                                                         \
   const char *get_module_name(void) { return TASK_NAME; }                   \
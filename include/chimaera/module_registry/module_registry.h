@@ -13,11 +13,16 @@
 #ifndef CHI_INCLUDE_CHI_TASK_TASK_REGISTRY_H_
 #define CHI_INCLUDE_CHI_TASK_TASK_REGISTRY_H_
 
+#include <atomic>
 #include <cstdlib>
 #include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "chimaera/config/config_server.h"
 #include "module.h"
@@ -105,10 +110,118 @@ struct ModuleInfo {
   }
 };
 
+/** Number of slots in the dense pool index (power of two) */
+#define CHI_POOL_SLOTS 4096
+/** Largest container id kept in a pool's dense container index */
+#define CHI_MAX_DENSE_CONTAINERS 65536
+
 struct PoolInfo {
+  PoolId id_;
   ModuleInfo *module_;
   std::string lib_name_;
   std::unordered_map<ContainerId, Container *> containers_;
+  std::vector<Container *> container_idx_; /**< Dense index of containers_ */
+
+  /** Rebuild the dense container index */
+  void Reindex() {
+    size_t size = 0;
+    for (auto &kv : containers_) {
+      if (kv.first < CHI_MAX_DENSE_CONTAINERS && kv.first >= size) {
+        size = kv.first + 1;
+      }
+    }
+    container_idx_.assign(size, nullptr);
+    for (auto &kv : containers_) {
+      if (kv.first < size) {
+        container_idx_[kv.first] = kv.second;
+      }
+    }
+  }
+
+  /** Find a container. One array access for dense ids. */
+  Container *GetContainer(ContainerId container_id) const {
+    if (container_id < container_idx_.size()) {
+      return container_idx_[container_id];
+    }
+    auto it = containers_.find(container_id);
+    if (it == containers_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+};
+
+/**
+ * A version of the pool table. Published versions are never modified.
+ * Pool ids are allocated densely, so slots_ resolves nearly every pool
+ * with one array access. The map resolves slot collisions.
+ * */
+struct PoolTable {
+  std::unordered_map<PoolId, PoolInfo> pools_;
+  std::vector<PoolInfo *> slots_; /**< Indexed by the pool's unique id */
+
+  /** Default constructor */
+  PoolTable() = default;
+
+  /** Copy constructor. The indexes point into \a other, so drop them. */
+  PoolTable(const PoolTable &other) : pools_(other.pools_) {}
+
+  /** Rebuild the dense indexes before publishing */
+  void Reindex() {
+    slots_.assign(CHI_POOL_SLOTS, nullptr);
+    for (auto &kv : pools_) {
+      PoolInfo &pool = kv.second;
+      pool.Reindex();
+      PoolInfo *&slot = slots_[GetSlot(kv.first)];
+      if (!slot) {
+        slot = &pool;
+      }
+    }
+  }
+
+  /** Get the dense slot of a pool */
+  static u64 GetSlot(const PoolId &pool_id) {
+    return pool_id.unique_ & (CHI_POOL_SLOTS - 1);
+  }
+
+  /** Find a pool */
+  PoolInfo *Find(const PoolId &pool_id) {
+    if (!slots_.empty()) {
+      PoolInfo *pool = slots_[GetSlot(pool_id)];
+      if (pool && pool->id_ == pool_id) {
+        return pool;
+      }
+    }
+    auto it = pools_.find(pool_id);
+    if (it == pools_.end()) {
+      return nullptr;
+    }
+    return &it->second;
+  }
+};
+
+/** A replaced pool table, freed once no reader can still see it */
+struct RetiredPoolTable {
+  PoolTable *table_;
+  std::vector<Container *> containers_; /**< Replaced containers to delete */
+  u64 epoch_; /**< Readers at or past this epoch see the newer table */
+};
+
+/** A thread's read-side epoch. 0 while the thread is not reading. */
+struct RegistryReader {
+  std::atomic<u64> epoch_ = 0;
+  std::atomic<bool> exited_ = false; /**< The thread exited, prune this */
+};
+
+/** Marks the calling thread's reader for pruning when the thread exits */
+struct RegistryReaderHandle {
+  RegistryReader *reader_ = nullptr;
+
+  ~RegistryReaderHandle() {
+    if (reader_) {
+      reader_->exited_.store(true, std::memory_order_release);
+    }
+  }
 };
 
 /**
@@ -124,16 +237,84 @@ class ModuleRegistry {
   std::unordered_map<std::string, ModuleInfo> libs_;
   /** Map of a semantic exec name to exec id */
   std::unordered_map<std::string, PoolId> pool_ids_;
-  /** Map of a semantic exec id to state */
-  std::unordered_map<PoolId, PoolInfo> pools_;
-  /** A unique identifier counter */
+  /**
+   * Map of a semantic exec id to state. Readers never lock: they load
+   * the current version under a ScopedPoolRead. Writers hold lock_, copy
+   * the table, and publish the copy. Replaced versions are freed once
+   * every reader has moved past them (epoch-based reclamation).
+   * */
+  std::atomic<PoolTable *> pools_;
+  /** The publication epoch of pools_ */
+  std::atomic<u64> epoch_;
+  /** Read-side epochs of every thread that read pools_ */
+  std::vector<std::unique_ptr<RegistryReader>> readers_;
+  std::mutex readers_lock_;
+  /** Replaced pool tables awaiting reclamation (lock_) */
+  std::vector<RetiredPoolTable> retired_;
+  /** The dense pool id counter */
   hipc::atomic<hshm::min_u64> *unique_;
   Mutex lock_;
   CoRwLock upgrade_lock_;
 
+ public:
+  /** Marks the calling thread as reading pools_. Wait-free. */
+  class ScopedPoolRead {
+   public:
+    ModuleRegistry &registry_;
+    RegistryReader *reader_;
+    bool outer_;
+    PoolTable *table_;
+
+   public:
+    /**
+     * Enter a read-side critical section. Must not span a coroutine
+     * yield, since other tasks on the thread share the reader.
+     * */
+    explicit ScopedPoolRead(ModuleRegistry &registry)
+        : registry_(registry), reader_(registry.GetReader()) {
+      outer_ = reader_->epoch_.load(std::memory_order_relaxed) == 0;
+      if (outer_) {
+        reader_->epoch_.store(registry.epoch_.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+      table_ = registry.pools_.load(std::memory_order_acquire);
+    }
+
+    /** Leave the read-side critical section */
+    ~ScopedPoolRead() {
+      if (outer_) {
+        reader_->epoch_.store(0, std::memory_order_release);
+      }
+    }
+
+    /** Find a pool in the table */
+    PoolInfo *Find(const PoolId &pool_id) { return table_->Find(pool_id); }
+
+    /** Whether a newer table was published after this read began */
+    bool IsStale() const {
+      return registry_.pools_.load(std::memory_order_acquire) != table_;
+    }
+  };
+
  public:
   /** Default constructor */
-  ModuleRegistry() { lock_.Init(); }
+  ModuleRegistry() {
+    lock_.Init();
+    pools_ = new PoolTable();
+    epoch_ = 1;
+  }
+
+  /** Free the pool tables. No thread may be reading at this point. */
+  ~ModuleRegistry() {
+    for (RetiredPoolTable &retired : retired_) {
+      delete retired.table_;
+      for (Container *container : retired.containers_) {
+        delete container;
+      }
+    }
+    delete pools_.load();
+  }
 
   /** Initialize the Task Registry */
   void ServerInit(ServerConfig *config, NodeId node_id,
@@ -320,16 +501,22 @@ class ModuleRegistry {
   void ReplaceContainer(Container *new_container) {
     ScopedMutex lock(lock_, 0);
     PoolId pool_id = new_container->id_;
-    auto it = pools_.find(pool_id);
-    if (it == pools_.end()) {
+    PoolTable *table = new PoolTable(*pools_.load());
+    auto it = table->pools_.find(pool_id);
+    if (it == table->pools_.end()) {
       HELOG(kError, "Could not find the pool: {}", pool_id);
+      delete table;
       return;
     }
     PoolInfo &pool = it->second;
     ContainerId container_id = new_container->container_id_;
     Container *old = pool.containers_[container_id];
     pool.containers_[container_id] = new_container;
-    delete old;
+    std::vector<Container *> retired;
+    if (old) {
+      retired.emplace_back(old);
+    }
+    PublishPools(table, std::move(retired));
   }
 
   /** Get or create a pool's ID */
@@ -368,56 +555,54 @@ class ModuleRegistry {
     return info.static_state_;
   }
 
-  /** Get the static state instance */
+  /**
+   * Get the static state instance. Static states are never freed, so the
+   * pointer stays valid after the read section ends.
+   * */
   Container *GetStaticContainer(const PoolId &pool_id) {
-    ScopedMutex lock(lock_, 0);
-    auto pool_it = pools_.find(pool_id);
-    if (pool_it == pools_.end()) {
-      return nullptr;
-    }
-    PoolInfo &pool = pool_it->second;
-    if (pool.module_->IsPlugged()) {
+    ScopedPoolRead read(*this);
+    PoolInfo *pool = read.Find(pool_id);
+    if (!pool) {
       return nullptr;
     }
-    auto it = libs_.find(pool.lib_name_);
-    if (it == libs_.end()) {
+    if (pool->module_->IsPlugged()) {
       return nullptr;
     }
-    return it->second.static_state_;
+    return pool->module_->static_state_;
   }
 
   /** Get pool instance by name OR by ID */
   PoolId PoolExists(const std::string &pool_name, const PoolId &pool_id) {
     PoolId id = GetPoolId(pool_name);
-    ScopedMutex lock(lock_, 0);
     if (id.IsNull()) {
       id = pool_id;
     }
-    auto it = pools_.find(id);
-    if (it == pools_.end()) {
+    ScopedPoolRead read(*this);
+    if (!read.Find(id)) {
       return PoolId::GetNull();
     }
     return id;
   }
 
-  /** Get a pool instance */
-  Container *GetContainer(const PoolId &pool_id,
+  /**
+   * Get a pool instance. The container may be replaced and freed once
+   * \a read ends, so it must only be used inside the read section.
+   * */
+  Container *GetContainer(ScopedPoolRead &read, const PoolId &pool_id,
                           const ContainerId &container_id) {
-    // ScopedMutex lock(lock_, 0);
-    auto pool_it = pools_.find(pool_id);
-    if (pool_it == pools_.end()) {
+    PoolInfo *pool = read.Find(pool_id);
+    if (!pool) {
       HELOG(kFatal, "Could not find pool {}", pool_id);
       return nullptr;
     }
-    PoolInfo &pool = pool_it->second;
-    if (pool.module_->IsPlugged()) {
+    if (pool->module_->IsPlugged()) {
       return nullptr;
     }
-    Container *exec = pool.containers_[container_id];
+    Container *exec = pool->GetContainer(container_id);
     if (!exec) {
       //      CHI_RPC->PrintDomain(DomainId{pool_id,
       //      SubDomainId::kContainerSet}); for (auto &kv :
-      //      pool_it->second.containers_) {
+      //      pool->containers_) {
       //        HILOG(kInfo, "Container ID: {} {}", kv.first, kv.second)
       //      }
       HELOG(kError, "Could not find container {} in pool {}", container_id,
@@ -429,23 +614,26 @@ class ModuleRegistry {
   /** Destroy a pool */
   void DestroyContainer(const PoolId &pool_id) {
     ScopedMutex lock(lock_, 0);
-    auto it = pools_.find(pool_id);
-    if (it == pools_.end()) {
+    PoolTable *table = new PoolTable(*pools_.load());
+    auto it = table->pools_.find(pool_id);
+    if (it == table->pools_.end()) {
       HELOG(kWarning, "Could not find the pool");
+      delete table;
       return;
     }
     PoolInfo &pool = it->second;
     std::string pool_name = pool.containers_[0]->name_;
     // TODO(llogan): Iterate over shared_state + states and destroy them
     pool_ids_.erase(pool_name);
-    pools_.erase(it);
+    table->pools_.erase(it);
+    PublishPools(table, {});
   }
 
   /** Get all ChiContainers matching the module name */
   std::vector<Container *> GetContainers(const std::string &lib_name) {
-    ScopedMutex lock(lock_, 0);
+    ScopedPoolRead read(*this);
     std::vector<Container *> containers;
-    for (auto &kv : pools_) {
+    for (auto &kv : read.table_->pools_) {
       PoolInfo &pool = kv.second;
       if (pool.lib_name_ == lib_name) {
         for (auto &kv2 : pool.containers_) {
@@ -479,6 +667,70 @@ class ModuleRegistry {
     ModuleInfo &info = it->second;
     info.UnsetPlugged();
   }
+
+  /** Get the calling thread's read-side epoch */
+  RegistryReader *GetReader() {
+    static thread_local RegistryReaderHandle handle;
+    if (!handle.reader_) {
+      std::lock_guard<std::mutex> guard(readers_lock_);
+      readers_.emplace_back(std::make_unique<RegistryReader>());
+      handle.reader_ = readers_.back().get();
+    }
+    return handle.reader_;
+  }
+
+ private:
+  /**
+   * Publish a new version of the pool table (lock_ held).
+   * The old version and \a containers are freed once no reader sees them.
+   * */
+  void PublishPools(PoolTable *table, std::vector<Container *> containers) {
+    table->Reindex();
+    PoolTable *old = pools_.exchange(table, std::memory_order_acq_rel);
+    u64 epoch = epoch_.fetch_add(1) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    retired_.emplace_back(RetiredPoolTable{old, std::move(containers), epoch});
+    ReclaimPools();
+  }
+
+  /** Free retired pool tables that no reader can see (lock_ held) */
+  void ReclaimPools() {
+    u64 min_epoch = std::numeric_limits<u64>::max();
+    {
+      std::lock_guard<std::mutex> guard(readers_lock_);
+      size_t live = 0;
+      for (size_t i = 0; i < readers_.size(); ++i) {
+        if (readers_[i]->exited_.load(std::memory_order_acquire)) {
+          continue;
+        }
+        u64 epoch = readers_[i]->epoch_.load(std::memory_order_acquire);
+        if (epoch && epoch < min_epoch) {
+          min_epoch = epoch;
+        }
+        if (live != i) {
+          readers_[live] = std::move(readers_[i]);
+        }
+        ++live;
+      }
+      readers_.resize(live);
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); ++i) {
+      RetiredPoolTable &retired = retired_[i];
+      if (retired.epoch_ <= min_epoch) {
+        delete retired.table_;
+        for (Container *container : retired.containers_) {
+          delete container;
+        }
+      } else {
+        if (kept != i) {
+          retired_[kept] = std::move(retired);
+        }
+        ++kept;
+      }
+    }
+    retired_.resize(kept);
+  }
 };
 
 /** Singleton macro for task registry */
@@ -13,7 +13,10 @@
 #ifndef CHI_TASK_DEFN_H
 #define CHI_TASK_DEFN_H
 
+#include <atomic>
 #include <csetjmp>
+#include <mutex>
+#include <vector>
 
 #include "chimaera/chimaera_types.h"
 
@@ -24,6 +27,13 @@ using LocalSerialize = hipc::LocalSerialize<DataT>;
 
 class Module;
 class Lane;
+struct Task;
+struct RunContext;
+struct ContainerQuiesce;
+class RunContextPool;
+
+/** A direct-dispatch entry that runs one method of a module */
+typedef void (*RunFun)(Module *exec, Task *task, RunContext &rctx);
 
 /** This task reads a state */
 #define TASK_READ BIT_OPT(chi::IntFlag, 0)
@@ -225,8 +235,12 @@ struct TaskNode {
 #define TF_LOCAL BIT_OPT(chi::IntFlag, 5)
 /** This task supports monitoring of all sub-methods */
 #define TF_MONITOR BIT_OPT(chi::IntFlag, 6)
-/** This task has a CompareGroup function */
+/** This task can be scheduled as part of a task group */
 #define TF_CMPGRP BIT_OPT(chi::IntFlag, 7)
+/** This task has Merge + MergeEnd functions */
+#define TF_MERGE BIT_OPT(chi::IntFlag, 8)
+/** This task's SerializeStart + SerializeEnd only touch fixed-size fields */
+#define TF_SRL_POD BIT_OPT(chi::IntFlag, 9)
 
 /** All tasks inherit this to easily check if a class is a task using SFINAE */
 class IsTask {};
@@ -240,6 +254,8 @@ class IsTask {};
 #define USES_SRL_START(T) T::SRL_SYM_START
 /** Determine this task uses SerializeEnd */
 #define USES_SRL_END(T) T::SRL_SYM_END
+/** Determine this task's serialized fields are all fixed-size */
+#define IS_SRL_POD(T) T::SRL_POD
 
 /** Compile-time flags indicating task methods and operation support */
 template <chi::IntFlag FLAGS>
@@ -250,8 +266,10 @@ struct TaskFlags : public IsTask {
   TASK_FLAG_T SUPPORTS_SRL = FLAGS & (TF_SRL_SYM | TF_SRL_ASYM);
   TASK_FLAG_T SRL_SYM_START = FLAGS & TF_SRL_SYM_START;
   TASK_FLAG_T SRL_SYM_END = FLAGS & TF_SRL_SYM_END;
+  TASK_FLAG_T SRL_POD = FLAGS & TF_SRL_POD;
   TASK_FLAG_T MONITOR = FLAGS & TF_MONITOR;
   TASK_FLAG_T CMPGRP = FLAGS & TF_CMPGRP;
+  TASK_FLAG_T MERGE = FLAGS & TF_MERGE;
 };
 
 /** Prioritization of tasks */
@@ -325,14 +343,18 @@ struct Load {
   }
 };
 
-/** Context passed to the Run method of a task */
+/**
+ * Context passed to the Run method of a task.
+ * Only exists while a task is in the runtime and lives in process-private
+ * memory, not in the task's shared-memory block.
+ * */
 struct RunContext {
-  ibitfield run_flags_;    /**< Properties of the task */
   ibitfield worker_props_; /**< Properties of the worker */
   WorkerId worker_id_;     /**< The worker id of the task */
   bctx::transfer_t jmp_;   /**< Stack info for coroutines */
   void *stack_ptr_;        /**< Stack pointer (coroutine) */
   Module *exec_;
+  RunFun run_fun_; /**< Direct-dispatch entry of the task's method */
   WorkPending *flush_;
   hshm::Timer timer_;
   Task *co_task_;
@@ -340,10 +362,163 @@ struct RunContext {
   std::vector<FullPtr<Task>> *replicas_;
   size_t ret_task_addr_;
   NodeId ret_node_;
-  hipc::atomic<int> block_count_ = 0;
   ContainerId route_container_id_;
   chi::Lane *route_lane_;
   Load load_;
+  std::vector<FullPtr<Task>> merged_; /**< Tasks merged into this one */
+  ContainerQuiesce *quiesce_; /**< Container counting this task in flight */
+  u64 quiesce_ver_;           /**< Container version exec_ belongs to */
+  RunContextPool *pool_;      /**< The pool that allocated this context */
+};
+
+/**
+ * Per-thread free list of runtime contexts.
+ * A task often ends on a different worker than the one that allocated
+ * its context. Such contexts are handed back to the allocating pool, so
+ * no pool grows without bound while another drains.
+ * */
+class RunContextPool {
+ public:
+  std::vector<RunContext *> free_;   /**< Owner thread's cache */
+  std::mutex remote_lock_;           /**< Protects remote_ */
+  std::vector<RunContext *> remote_; /**< Returned by other threads */
+  std::atomic<bool> has_remote_{false};
+
+ public:
+  /** Get this thread's pool. Pools outlive their threads. */
+  static RunContextPool &Get() {
+    static thread_local RunContextPool *pool = new RunContextPool();
+    return *pool;
+  }
+
+  /** Allocate a zero-initialized context */
+  static RunContext *Allocate() {
+    RunContextPool &pool = Get();
+    if (pool.free_.empty()) {
+      pool.Reclaim();
+    }
+    RunContext *rctx;
+    if (pool.free_.empty()) {
+      rctx = new RunContext();
+    } else {
+      rctx = pool.free_.back();
+      pool.free_.pop_back();
+      *rctx = RunContext();
+    }
+    rctx->pool_ = &pool;
+    return rctx;
+  }
+
+  /** Return a context to the pool that allocated it */
+  static void Free(RunContext *rctx) {
+    RunContextPool *owner = rctx->pool_;
+    if (owner == &Get()) {
+      owner->free_.push_back(rctx);
+      return;
+    }
+    std::lock_guard<std::mutex> guard(owner->remote_lock_);
+    owner->remote_.push_back(rctx);
+    owner->has_remote_.store(true, std::memory_order_release);
+  }
+
+ private:
+  /** Take back the contexts other threads returned */
+  void Reclaim() {
+    if (!has_remote_.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(remote_lock_);
+    free_.swap(remote_);
+    has_remote_.store(false, std::memory_order_relaxed);
+  }
+};
+
+/** Default capacity of inline task payloads (bytes) */
+#define CHI_TASK_INLINE_SIZE 256
+
+/**
+ * A task payload. Payloads that fit in INLINE_SIZE are stored in the task
+ * itself, avoiding a data buffer allocation. Larger payloads reference an
+ * external buffer. Tasks that own their payload allocate it with
+ * Client::AllocateTaskData and write it in place; tasks that reference a
+ * caller's buffer should keep a plain pointer instead.
+ * */
+template <size_t INLINE_SIZE = CHI_TASK_INLINE_SIZE>
+struct TaskData {
+  hipc::Pointer ext_;        /**< External buffer (null if inline) */
+  size_t size_;              /**< Size of the payload */
+  char inline_[INLINE_SIZE]; /**< Inline payload */
+
+  /** Default constructor */
+  HSHM_INLINE_CROSS_FUN
+  TaskData() : ext_(hipc::Pointer::GetNull()), size_(0) {}
+
+  /** Whether a payload of \a size can be stored inline */
+  HSHM_INLINE_CROSS_FUN
+  static constexpr bool Fits(size_t size) { return size <= INLINE_SIZE; }
+
+  /** Whether the payload is stored inline */
+  HSHM_INLINE_CROSS_FUN
+  bool IsInline() const { return ext_.IsNull(); }
+
+  /** Store a payload of \a size inline */
+  HSHM_INLINE_CROSS_FUN
+  void SetInline(size_t size) {
+    ext_ = hipc::Pointer::GetNull();
+    size_ = size;
+  }
+
+  /** Reference an external buffer */
+  HSHM_INLINE_CROSS_FUN
+  void SetExternal(const hipc::Pointer &data, size_t size) {
+    ext_ = data;
+    size_ = size;
+  }
+
+  /** Get the payload in this process */
+  HSHM_INLINE_CROSS_FUN
+  char *data() {
+    if (IsInline()) {
+      return inline_;
+    }
+    return HSHM_MEMORY_MANAGER->Convert<char>(ext_);
+  }
+
+  /** Get the size of the payload */
+  HSHM_INLINE_CROSS_FUN
+  size_t size() const { return size_; }
+};
+
+/** A DAG edge: start child_ once the task owning the edge completes */
+struct DagEdge {
+  hipc::Pointer child_; /**< The dependent task */
+  hipc::Pointer next_;  /**< The next edge of the owning task */
+  bool pass_output_;    /**< Set the child's dag_input_ to the owning task */
+};
+
+/** States of Task::futex_ */
+enum TaskFutexState : u32 {
+  kTaskFutexIdle = 0,     /**< No client sleeps on the task */
+  kTaskFutexSleeping = 1, /**< A client sleeps on the task */
+  kTaskFutexComplete = 2, /**< The runtime is completing the task */
+};
+
+/**
+ * Links of a task into a DAG or a task group. Most tasks use neither, so
+ * the links live in a side block allocated on first use, keeping the
+ * task header compact.
+ * */
+struct TaskLinks {
+  hipc::Pointer dag_edges_ =
+      hipc::Pointer::GetNull(); /**< Tasks started when this completes */
+  hipc::Pointer dag_input_ =
+      hipc::Pointer::GetNull(); /**< Task whose output feeds this one */
+  hipc::atomic<u32> dag_deps_ = 0; /**< # of unfinished DAG predecessors */
+  hipc::Pointer grp_leader_ =
+      hipc::Pointer::GetNull(); /**< First task of this task's group */
+  hipc::Pointer grp_next_ =
+      hipc::Pointer::GetNull(); /**< Next unrouted task of the group */
+  hipc::atomic<u32> grp_pending_ = 0; /**< # of unfinished group tasks */
 };
 
 /** A generic task base class */
@@ -355,9 +530,16 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   MethodId method_;       /**< The method to call in the state */
   TaskPrio prio_;         /**< Priority of the request */
   ibitfield task_flags_;  /**< Properties of the task */
+  ibitfield run_flags_;   /**< Runtime properties of the task */
+  hipc::atomic<int> block_count_ = 0; /**< # of subtasks blocking this */
   double period_ns_;      /**< The period of the task */
   size_t start_;          /**< The time the task started */
-  RunContext rctx_;
+  RunContext *rctx_ = nullptr; /**< Runtime context (runtime-only) */
+  hipc::Pointer cq_ =
+      hipc::Pointer::GetNull(); /**< Completion queue notified on end */
+  std::atomic<u32> futex_ = 0;  /**< Waiter state (TaskFutexState) */
+  hipc::Pointer links_ =
+      hipc::Pointer::GetNull(); /**< TaskLinks of DAG and group tasks */
   // #ifdef CHIMAERA_TASK_DEBUG
   std::atomic<int> delcnt_ = 0; /**< # of times deltask called */
                                 // #endif
@@ -438,6 +620,14 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   HSHM_INLINE_CROSS_FUN
   void UnsetDataOwner() { task_flags_.UnsetBits(TASK_DATA_OWNER); }
 
+  /** Allow this task to merge with tasks queued after it */
+  HSHM_INLINE_CROSS_FUN
+  void SetMergeable() { task_flags_.SetBits(TASK_MERGE); }
+
+  /** Check if task can merge with tasks queued after it */
+  HSHM_INLINE_CROSS_FUN
+  bool IsMergeable() const { return task_flags_.Any(TASK_MERGE); }
+
   /** Set this task as started */
   HSHM_INLINE_CROSS_FUN
   void SetRemoteDebug() { task_flags_.SetBits(TASK_REMOTE_DEBUG_MARK); }
@@ -466,6 +656,18 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   HSHM_INLINE_CROSS_FUN
   void UnsetYielded() { task_flags_.UnsetBits(TASK_YIELDED); }
 
+  /**
+   * Push this task to a completion queue when it completes. The task then
+   * belongs to the reaper: it must not be waited on, and it may only be
+   * freed once ReapCompletions has returned it.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  void SetCompletionQueue(const hipc::Pointer &cq) { cq_ = cq; }
+
+  /** Check if this task is bound to a completion queue */
+  HSHM_INLINE_CROSS_FUN
+  bool HasCompletionQueue() const { return !cq_.IsNull(); }
+
   /** Set period in nanoseconds */
   HSHM_INLINE_CROSS_FUN
   void SetPeriodNs(double ns) { period_ns_ = ns; }
@@ -528,93 +730,93 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
 
   /** Set this task as routed */
   HSHM_INLINE_CROSS_FUN
-  void SetRouted() { rctx_.run_flags_.SetBits(TASK_IS_ROUTED); }
+  void SetRouted() { run_flags_.SetBits(TASK_IS_ROUTED); }
 
   /** Check if task is routed */
   HSHM_INLINE_CROSS_FUN
-  bool IsRouted() const { return rctx_.run_flags_.Any(TASK_IS_ROUTED); }
+  bool IsRouted() const { return run_flags_.Any(TASK_IS_ROUTED); }
 
   /** Unset this task as routed */
   HSHM_INLINE_CROSS_FUN
-  void UnsetRouted() { rctx_.run_flags_.UnsetBits(TASK_IS_ROUTED); }
+  void UnsetRouted() { run_flags_.UnsetBits(TASK_IS_ROUTED); }
 
   /** Set this task as started */
   HSHM_INLINE_CROSS_FUN
-  void SetStarted() { rctx_.run_flags_.SetBits(TASK_HAS_STARTED); }
+  void SetStarted() { run_flags_.SetBits(TASK_HAS_STARTED); }
 
   /** Set this task as started */
   HSHM_INLINE_CROSS_FUN
-  void UnsetStarted() { rctx_.run_flags_.UnsetBits(TASK_HAS_STARTED); }
+  void UnsetStarted() { run_flags_.UnsetBits(TASK_HAS_STARTED); }
 
   /** Check if task has started */
   HSHM_INLINE_CROSS_FUN
-  bool IsStarted() const { return rctx_.run_flags_.Any(TASK_HAS_STARTED); }
+  bool IsStarted() const { return run_flags_.Any(TASK_HAS_STARTED); }
 
   /** Set blocked */
   HSHM_INLINE_CROSS_FUN
-  void SetBlocked(int count) { rctx_.block_count_ += count; }
+  void SetBlocked(int count) { block_count_ += count; }
 
   /** Check if task is blocked */
   HSHM_INLINE_CROSS_FUN
-  bool IsBlocked() const { return rctx_.block_count_.load() > 0; }
+  bool IsBlocked() const { return block_count_.load() > 0; }
 
   /** Mark task as routed */
   HSHM_INLINE_CROSS_FUN
-  void SetShouldSample() { rctx_.run_flags_.SetBits(TASK_SHOULD_SAMPLE); }
+  void SetShouldSample() { run_flags_.SetBits(TASK_SHOULD_SAMPLE); }
 
   /** Check if task is routed */
   HSHM_INLINE_CROSS_FUN
-  bool ShouldSample() const { return rctx_.run_flags_.Any(TASK_SHOULD_SAMPLE); }
+  bool ShouldSample() const { return run_flags_.Any(TASK_SHOULD_SAMPLE); }
 
   /** Unset task as routed */
   HSHM_INLINE_CROSS_FUN
-  void UnsetShouldSample() { rctx_.run_flags_.UnsetBits(TASK_SHOULD_SAMPLE); }
+  void UnsetShouldSample() { run_flags_.UnsetBits(TASK_SHOULD_SAMPLE); }
 
   /** Set signal complete */
   HSHM_INLINE_CROSS_FUN
-  void SetSignalUnblock() { rctx_.run_flags_.SetBits(TASK_SIGNAL_COMPLETE); }
+  void SetSignalUnblock() { run_flags_.SetBits(TASK_SIGNAL_COMPLETE); }
 
   /** Check if task should signal complete */
   HSHM_INLINE_CROSS_FUN
   bool ShouldSignalUnblock() const {
-    return rctx_.run_flags_.Any(TASK_SIGNAL_COMPLETE);
+    return run_flags_.Any(TASK_SIGNAL_COMPLETE);
   }
 
   /** Unset signal complete */
   HSHM_INLINE_CROSS_FUN
   void UnsetSignalUnblock() {
-    rctx_.run_flags_.UnsetBits(TASK_SIGNAL_COMPLETE);
+    run_flags_.UnsetBits(TASK_SIGNAL_COMPLETE);
   }
 
   /** Set signal remote complete */
   HSHM_INLINE_CROSS_FUN
   void SetSignalRemoteComplete() {
-    rctx_.run_flags_.SetBits(TASK_SIGNAL_REMOTE_COMPLETE);
+    run_flags_.SetBits(TASK_SIGNAL_REMOTE_COMPLETE);
   }
 
   /** Check if task should signal complete */
   HSHM_INLINE_CROSS_FUN
   bool ShouldSignalRemoteComplete() {
-    return rctx_.run_flags_.Any(TASK_SIGNAL_REMOTE_COMPLETE);
+    return run_flags_.Any(TASK_SIGNAL_REMOTE_COMPLETE);
   }
 
   /** Unset signal complete */
   HSHM_INLINE_CROSS_FUN
   void UnsetSignalRemoteComplete() {
-    rctx_.run_flags_.UnsetBits(TASK_SIGNAL_REMOTE_COMPLETE);
+    run_flags_.UnsetBits(TASK_SIGNAL_REMOTE_COMPLETE);
   }
 
   /** Mark this task as remote */
   HSHM_INLINE_CROSS_FUN
-  void SetRemote() { rctx_.run_flags_.SetBits(TASK_REMOTE); }
+  void SetRemote() { run_flags_.SetBits(TASK_REMOTE); }
 
   /** Check if task is remote */
   HSHM_INLINE_CROSS_FUN
-  bool IsRemote() const { return rctx_.run_flags_.Any(TASK_REMOTE); }
+  bool IsRemote() const { return run_flags_.Any(TASK_REMOTE); }
 
   /** Unset remote */
   HSHM_INLINE_CROSS_FUN
-  void UnsetRemote() { rctx_.run_flags_.UnsetBits(TASK_REMOTE); }
+  void UnsetRemote() { run_flags_.UnsetBits(TASK_REMOTE); }
 
   /** Determine if time has elapsed */
   bool ShouldRun(CacheTimer &cur_time, bool flushing) {
@@ -635,6 +837,98 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   /** Mark this task as having been run */
   void DidRun(CacheTimer &cur_time) { start_ = cur_time.GetNsecFromStart(); }
 
+  /**====================================
+   * Task DAGs
+   * ===================================*/
+
+  /** Get the DAG and group links, or nullptr if the task has none */
+  HSHM_INLINE_CROSS_FUN
+  TaskLinks *GetLinks() const {
+    if (links_.IsNull()) {
+      return nullptr;
+    }
+    return HSHM_MEMORY_MANAGER->Convert<TaskLinks>(links_);
+  }
+
+  /** Whether tasks depend on this one */
+  HSHM_INLINE_CROSS_FUN
+  bool HasDagEdges() const {
+    TaskLinks *links = GetLinks();
+    return links && !links->dag_edges_.IsNull();
+  }
+
+  /** Whether this task waits for unfinished predecessors */
+  HSHM_INLINE_CROSS_FUN
+  bool HasDagDeps() const {
+    TaskLinks *links = GetLinks();
+    return links && links->dag_deps_.load() > 0;
+  }
+
+  /** Get the predecessor whose output was passed to this task */
+  template <typename TaskT = Task>
+  HSHM_INLINE_CROSS_FUN FullPtr<TaskT> GetDagInput() {
+    TaskLinks *links = GetLinks();
+    if (!links) {
+      return FullPtr<TaskT>(hipc::Pointer::GetNull());
+    }
+    return FullPtr<TaskT>(links->dag_input_);
+  }
+
+  /**====================================
+   * Task Groups
+   * ===================================*/
+
+  /** Whether this task belongs to an unfinished group */
+  HSHM_INLINE_CROSS_FUN
+  bool IsGrouped() const {
+    TaskLinks *links = GetLinks();
+    return links && !links->grp_leader_.IsNull();
+  }
+
+  /** Whether group members still need to be routed behind this task */
+  HSHM_INLINE_CROSS_FUN
+  bool HasGroupMembers() const {
+    TaskLinks *links = GetLinks();
+    return links && !links->grp_next_.IsNull();
+  }
+
+  /** Detach the unrouted members of this task's group */
+  HSHM_INLINE_CROSS_FUN
+  hipc::Pointer TakeGroupMembers() {
+    TaskLinks *links = GetLinks();
+    if (!links) {
+      return hipc::Pointer::GetNull();
+    }
+    hipc::Pointer members = links->grp_next_;
+    links->grp_next_ = hipc::Pointer::GetNull();
+    return members;
+  }
+
+  /**====================================
+   * Runtime Context
+   * ===================================*/
+
+  /** Get the runtime context, allocating it on first use (runtime-only) */
+  RunContext &GetRunContext() {
+    if (!rctx_) {
+      rctx_ = RunContextPool::Allocate();
+    }
+    return *rctx_;
+  }
+
+  /** Get the address of the task to reply to, or 0 without a context */
+  size_t GetRetTaskAddr() const {
+    return rctx_ ? rctx_->ret_task_addr_ : 0;
+  }
+
+  /** Release the runtime context (runtime-only) */
+  void FreeRunContext() {
+    if (rctx_) {
+      RunContextPool::Free(rctx_);
+      rctx_ = nullptr;
+    }
+  }
+
   /**====================================
    * Yield and Wait Routines
    * ===================================*/
@@ -643,7 +937,7 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   HSHM_INLINE_CROSS_FUN
   void YieldCo() {
 #ifdef HSHM_IS_HOST
-    rctx_.jmp_ = bctx::jump_fcontext(rctx_.jmp_.fctx, nullptr);
+    rctx_->jmp_ = bctx::jump_fcontext(rctx_->jmp_.fctx, nullptr);
 #endif
   }
 
@@ -698,7 +992,7 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   void YieldInit(Task *parent_task) {
 #if defined(CHIMAERA_RUNTIME) and defined(HSHM_IS_HOST)
     if (parent_task && !IsFireAndForget() && !IsLongRunning()) {
-      rctx_.pending_to_ = parent_task;
+      GetRunContext().pending_to_ = parent_task;
       SetSignalUnblock();
     }
 #endif
@@ -708,6 +1002,33 @@ struct Task : public hipc::ShmContainer, public hipc::list_queue_entry {
   HSHM_CROSS_FUN
   void Wait(chi::IntFlag flags = TASK_COMPLETE);
 
+  /** Spin briefly, then sleep on futex_ until EndTask wakes us */
+  void FutexWait();
+
+  /**
+   * Mark the task complete and wake a client sleeping in FutexWait.
+   * The owner may free the task as soon as it observes completion, so the
+   * waiter state is claimed with one exchange before completion is
+   * published. Nothing in the task is touched afterwards: the wake only
+   * hands the futex address to the kernel as a key.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  void SetCompleteAndWake() {
+#ifdef HSHM_IS_HOST
+    u32 *addr = reinterpret_cast<u32 *>(&futex_);
+    bool sleeping = futex_.exchange(kTaskFutexComplete) == kTaskFutexSleeping;
+    SetComplete();
+    if (sleeping) {
+      WakeWaiterSlow(addr);
+    }
+#else
+    SetComplete();
+#endif
+  }
+
+  /** Issue the futex wake */
+  static void WakeWaiterSlow(u32 *addr);
+
   /** Spin wait */
   HSHM_INLINE_CROSS_FUN
   void SpinWait(chi::IntFlag flags = TASK_COMPLETE) {
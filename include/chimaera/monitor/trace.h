@@ -0,0 +1,170 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Distributed under BSD 3-Clause license.                                   *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Illinois Institute of Technology.                        *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of Hermes. The full Hermes copyright notice, including  *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the top directory. If you do not  *
+ * have access to the file, you may request a copy from help@hdfgroup.org.   *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHI_INCLUDE_CHI_MONITOR_TRACE_H_
+#define CHI_INCLUDE_CHI_MONITOR_TRACE_H_
+
+#include <time.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "chimaera/module_registry/task.h"
+
+namespace chi {
+
+/** Events recorded by the tracer */
+enum class TraceEvent : u16 {
+  kSchedule = 0, /**< A task was sent to the runtime */
+  kIngest = 1,   /**< A worker routed a task */
+  kRun = 2,      /**< A worker started or resumed a task */
+  kEnd = 3,      /**< A task completed */
+};
+
+/** A binary trace record */
+struct TraceRecord {
+  u64 time_ns_; /**< Monotonic time of the event */
+  u64 unique_;  /**< Unique part of the task's root id */
+  u32 node_id_; /**< Node of the task's root id */
+  u16 depth_;   /**< Depth of the task in its task graph */
+  u16 event_;   /**< The TraceEvent */
+};
+
+/** Number of records per thread (power of two) */
+#define CHI_TRACE_DEPTH 16384
+
+/** A thread's trace records. The oldest records are overwritten. */
+struct TraceRing {
+  TraceRecord records_[CHI_TRACE_DEPTH];
+  std::atomic<u64> count_ = 0;
+
+  /** Append a record */
+  void Record(TraceEvent event, const TaskNode &task_node) {
+    u64 idx = count_.load(std::memory_order_relaxed);
+    TraceRecord &rec = records_[idx & (CHI_TRACE_DEPTH - 1)];
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    rec.time_ns_ = (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+    rec.unique_ = task_node.root_.unique_;
+    rec.node_id_ = task_node.root_.node_id_;
+    rec.depth_ = (u16)task_node.node_depth_;
+    rec.event_ = (u16)event;
+    count_.store(idx + 1, std::memory_order_release);
+  }
+};
+
+/**
+ * Collects per-thread binary trace rings. Compiled in with
+ * CHIMAERA_ENABLE_TRACE and switched on at runtime with Enable() or the
+ * CHIMAERA_TRACE environment variable.
+ * */
+class Tracer {
+ public:
+  std::atomic<bool> enabled_;
+  std::mutex lock_;
+  std::vector<std::unique_ptr<TraceRing>> rings_;
+
+ public:
+  /** Default constructor */
+  Tracer() { enabled_ = getenv("CHIMAERA_TRACE") != nullptr; }
+
+  /** Start recording */
+  void Enable() { enabled_.store(true); }
+
+  /** Stop recording */
+  void Disable() { enabled_.store(false); }
+
+  /** Whether events are recorded */
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** Record an event for a task on this thread */
+  void Record(TraceEvent event, const TaskNode &task_node) {
+    if (!IsEnabled()) {
+      return;
+    }
+    static thread_local TraceRing *ring = RegisterRing();
+    ring->Record(event, task_node);
+  }
+
+  /** Copy out the records of every thread, oldest first per thread */
+  std::vector<TraceRecord> Collect() {
+    std::vector<TraceRecord> records;
+    std::lock_guard<std::mutex> guard(lock_);
+    for (std::unique_ptr<TraceRing> &ring : rings_) {
+      u64 count = ring->count_.load(std::memory_order_acquire);
+      u64 first = count > CHI_TRACE_DEPTH ? count - CHI_TRACE_DEPTH : 0;
+      for (u64 i = first; i < count; ++i) {
+        records.emplace_back(ring->records_[i & (CHI_TRACE_DEPTH - 1)]);
+      }
+    }
+    return records;
+  }
+
+  /** Write the collected records to \a path as raw TraceRecords */
+  bool Dump(const std::string &path) {
+    std::vector<TraceRecord> records = Collect();
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    size_t count = fwrite(records.data(), sizeof(TraceRecord), records.size(),
+                          file);
+    fclose(file);
+    return count == records.size();
+  }
+
+ private:
+  /** Create this thread's ring. Rings outlive their threads. */
+  TraceRing *RegisterRing() {
+    std::lock_guard<std::mutex> guard(lock_);
+    rings_.emplace_back(std::make_unique<TraceRing>());
+    return rings_.back().get();
+  }
+};
+
+}  // namespace chi
+
+#define CHI_TRACER hshm::Singleton<chi::Tracer>::GetInstance()
+
+namespace chi {
+
+/** Record a trace event for a task (host only) */
+static HSHM_INLINE_CROSS_FUN void TraceTask(TraceEvent event,
+                                            const TaskNode &task_node) {
+#ifdef HSHM_IS_HOST
+  CHI_TRACER->Record(event, task_node);
+#endif
+}
+
+}  // namespace chi
+
+/** Record a trace event. Compiled out unless CHIMAERA_ENABLE_TRACE. */
+#ifdef CHIMAERA_ENABLE_TRACE
+#define CHI_TRACE(event, task_node) \
+  chi::TraceTask(chi::TraceEvent::event, task_node)
+#else
+#define CHI_TRACE(event, task_node)
+#endif
+
+/** Per-task debug log. Compiled out unless CHIMAERA_ENABLE_TASK_LOGS. */
+#ifdef CHIMAERA_ENABLE_TASK_LOGS
+#define CHI_TASK_LOG(...) HILOG(kDebug, __VA_ARGS__)
+#else
+#define CHI_TASK_LOG(...)
+#endif
+
+#endif  // CHI_INCLUDE_CHI_MONITOR_TRACE_H_
@@ -16,7 +16,9 @@
 #include "chimaera/chimaera_types.h"
 #include "chimaera/module_registry/task.h"
 //  #include "chimaera_codegen/api/chimaera_client.h"
+#include <cstring>
 #include <sstream>
+#include <type_traits>
 
 namespace chi {
 
@@ -142,6 +144,61 @@ class SegmentedTransfer {
   }
 };
 
+/** Max bytes of fixed-size fields packed into one archive write */
+#define CHI_SRL_POD_MAX 512
+
+/**
+ * Packs fixed-size fields into a flat buffer with memcpy.
+ * Trivially-copyable fields are copied whole; other classes are walked
+ * through their serialize() function. The binary archives use this to
+ * write a task's header (and all fields of TF_SRL_POD tasks) with a single
+ * cereal call instead of one call per field.
+ * */
+template <bool SAVE>
+class PodArchive {
+ public:
+  char buf_[CHI_SRL_POD_MAX];
+  size_t off_ = 0;
+  size_t size_ = CHI_SRL_POD_MAX; /**< Bytes that may be packed or read */
+
+ public:
+  /** Pack using call */
+  template <typename... Args>
+  PodArchive &operator()(Args &&...args) {
+    (Pack(args), ...);
+    return *this;
+  }
+
+  /** Pack using ampersand */
+  template <typename T>
+  PodArchive &operator&(T &var) {
+    Pack(var);
+    return *this;
+  }
+
+  /** Copy one field to or from the buffer */
+  template <typename T>
+  void Pack(T &var) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (off_ + sizeof(T) > size_) {
+        HELOG(kFatal, "Fixed-size fields exceed {} bytes", size_);
+        return;
+      }
+      if constexpr (SAVE) {
+        memcpy(buf_ + off_, &var, sizeof(T));
+      } else {
+        memcpy(&var, buf_ + off_, sizeof(T));
+      }
+      off_ += sizeof(T);
+    } else {
+      var.serialize(*this);
+    }
+  }
+
+  /** Whether every recorded byte was unpacked */
+  bool IsConsumed() const { return off_ == size_; }
+};
+
 /** Serialize a task or task set */
 template <bool is_start>
 class BinaryOutputArchive {
@@ -178,6 +235,28 @@ class BinaryOutputArchive {
     return *this;
   }
 
+  /** Serialize a task payload. Inline payloads travel with the metadata. */
+  template <size_t INLINE_SIZE>
+  BinaryOutputArchive &bulk(chi::IntFlag flags, TaskData<INLINE_SIZE> &data) {
+    bool is_inline = data.IsInline();
+    ar_ << is_inline << data.size_;
+    if (!is_inline) {
+      return bulk(flags, data.ext_, data.size_);
+    }
+    if ((flags & DT_WRITE) == DT_WRITE) {
+      ar_ << cereal::binary_data(data.inline_, data.size_);
+    }
+    return *this;
+  }
+
+  /** Serialize fixed-size fields with a single archive write */
+  template <typename... Args>
+  BinaryOutputArchive &pod(Args &&...args) {
+    PodArchive<true> pack;
+    pack(std::forward<Args>(args)...);
+    return WritePod(pack);
+  }
+
   /** Serialize using left shift */
   template <typename T>
   BinaryOutputArchive &operator<<(T &var) {
@@ -215,18 +294,28 @@ class BinaryOutputArchive {
     if constexpr (IS_TASK(T)) {
       if constexpr (IS_SRL(T)) {
         if constexpr (is_start) {
-          var.template task_serialize<BinaryOutputArchive>((*this));
           xfer_.tasks_.emplace_back(var.pool_, var.method_, (size_t)&var,
                                     var.dom_query_);
-          if constexpr (USES_SRL_START(T)) {
+          PodArchive<true> pod;
+          var.template task_serialize<PodArchive<true>>(pod);
+          if constexpr (IS_SRL_POD(T)) {
+            var.SerializeStart(pod);
+            WritePod(pod);
+          } else if constexpr (USES_SRL_START(T)) {
+            WritePod(pod);
             var.SerializeStart(*this);
           } else {
+            WritePod(pod);
             var.SaveStart(*this);
           }
         } else {
           xfer_.tasks_.emplace_back(var.pool_, var.method_,
-                                    var.rctx_.ret_task_addr_);
-          if constexpr (USES_SRL_END(T)) {
+                                    var.GetRetTaskAddr());
+          if constexpr (IS_SRL_POD(T)) {
+            PodArchive<true> pod;
+            var.SerializeEnd(pod);
+            WritePod(pod);
+          } else if constexpr (USES_SRL_END(T)) {
             var.SerializeEnd(*this);
           } else {
             var.SaveEnd(*this);
@@ -242,6 +331,12 @@ class BinaryOutputArchive {
   /** End serialization recursion */
   BinaryOutputArchive &Serialize() { return *this; }
 
+  /** Write packed fixed-size fields */
+  BinaryOutputArchive &WritePod(PodArchive<true> &pod) {
+    ar_ << pod.off_ << cereal::binary_data(pod.buf_, pod.off_);
+    return *this;
+  }
+
   /** Get serialized data */
   SegmentedTransfer Get() {
     xfer_.md_ = ss_.str();
@@ -291,6 +386,34 @@ class BinaryInputArchive {
     return *this;
   }
 
+  /** Deserialize a task payload. Inline payloads travel with the metadata. */
+  template <size_t INLINE_SIZE>
+  BinaryInputArchive &bulk(chi::IntFlag flags, TaskData<INLINE_SIZE> &data) {
+    bool is_inline;
+    size_t data_size;
+    ar_ >> is_inline >> data_size;
+    if (!is_inline) {
+      if constexpr (is_start) {
+        data.size_ = data_size;
+      }
+      return bulk(flags, data.ext_, data.size_);
+    }
+    data.SetInline(data_size);
+    if ((flags & DT_WRITE) == DT_WRITE) {
+      ar_ >> cereal::binary_data(data.inline_, data_size);
+    }
+    return *this;
+  }
+
+  /** Deserialize fixed-size fields with a single archive read */
+  template <typename... Args>
+  BinaryInputArchive &pod(Args &&...args) {
+    PodArchive<false> pack;
+    ReadPod(pack);
+    pack(std::forward<Args>(args)...);
+    return CheckPod(pack);
+  }
+
   /** Deserialize using call */
   template <typename T, typename... Args>
   BinaryInputArchive &operator()(T &var, Args &&...args) {
@@ -322,14 +445,26 @@ class BinaryInputArchive {
     if constexpr (IS_TASK(T)) {
       if constexpr (IS_SRL(T)) {
         if constexpr (is_start) {
-          var.template task_serialize<BinaryInputArchive>((*this));
-          if constexpr (USES_SRL_START(T)) {
+          PodArchive<false> pod;
+          ReadPod(pod);
+          var.template task_serialize<PodArchive<false>>(pod);
+          if constexpr (IS_SRL_POD(T)) {
+            var.SerializeStart(pod);
+            CheckPod(pod);
+          } else if constexpr (USES_SRL_START(T)) {
+            CheckPod(pod);
             var.SerializeStart(*this);
           } else {
+            CheckPod(pod);
             var.LoadStart(*this);
           }
         } else {
-          if constexpr (USES_SRL_END(T)) {
+          if constexpr (IS_SRL_POD(T)) {
+            PodArchive<false> pod;
+            ReadPod(pod);
+            var.SerializeEnd(pod);
+            CheckPod(pod);
+          } else if constexpr (USES_SRL_END(T)) {
             var.SerializeEnd(*this);
           } else {
             var.LoadEnd(*this);
@@ -345,6 +480,28 @@ class BinaryInputArchive {
   /** End deserialize recursion */
   HSHM_INLINE
   BinaryInputArchive &Deserialize() { return *this; }
+
+  /** Read packed fixed-size fields. Fields are unpacked in write order. */
+  BinaryInputArchive &ReadPod(PodArchive<false> &pod) {
+    size_t size;
+    ar_ >> size;
+    if (size > CHI_SRL_POD_MAX) {
+      HELOG(kFatal, "Fixed-size fields exceed {} bytes", CHI_SRL_POD_MAX);
+      return *this;
+    }
+    ar_ >> cereal::binary_data(pod.buf_, size);
+    pod.size_ = size;
+    return *this;
+  }
+
+  /** Verify the fields read match the byte count that was written */
+  BinaryInputArchive &CheckPod(const PodArchive<false> &pod) {
+    if (!pod.IsConsumed()) {
+      HELOG(kFatal, "Read {} bytes of fixed-size fields, but {} were written",
+            pod.off_, pod.size_);
+    }
+    return *this;
+  }
 };
 
 }  // namespace chi
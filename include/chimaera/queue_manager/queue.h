@@ -24,9 +24,9 @@
 #define QUEUE_LOW_LATENCY BIT_OPT(chi::IntFlag, 1)
 /** This queue contains primarily throughput-intense tasks */
 #define QUEUE_HIGH_LATENCY 0
-/** This queue is currently being resized */
+/** This queue is currently being resized (emplace is plugged) */
 #define QUEUE_RESIZE BIT_OPT(chi::IntFlag, 2)
-/** This queue is currently processing updates */
+/** This queue is currently processing updates (pop is plugged) */
 #define QUEUE_UPDATE BIT_OPT(chi::IntFlag, 3)
 /** Requests in this queue can be processed in any order */
 #define QUEUE_UNORDERED BIT_OPT(chi::IntFlag, 4)
@@ -142,12 +142,34 @@ typedef hipc::Pointer LaneData;
 /** Queue token*/
 using hshm::qtok_t;
 
-/** Represents a lane tasks can be stored */
+/**
+ * Completed tasks bound to this queue are pushed here by the runtime,
+ * so a client can reap completions in batches. If it is full, the
+ * runtime keeps the completion and retries until the client reaps, so
+ * completions are delayed but never dropped.
+ * */
+typedef hipc::mpsc_queue<LaneData, CHI_ALLOC_T> CompletionQueue;
+
+/**
+ * Represents a lane tasks can be stored.
+ * Read-mostly metadata, the ring, producer-side and consumer-side
+ * counters are each kept on their own cache line. Lanes live in shared
+ * memory vectors whose base address is not cache-aligned, so the groups
+ * are separated by whole lines of padding instead of relying on alignas.
+ * */
 class Lane : public hipc::ShmContainer {
  public:
-  hipc::mpsc_queue<LaneData, CHI_ALLOC_T> queue_;
   QueueId id_;
   i32 worker_id_ = -1;
+  char pad0_[CHI_CACHE_LINE_SIZE];
+  alignas(CHI_CACHE_LINE_SIZE) hipc::mpsc_queue<LaneData, CHI_ALLOC_T> queue_;
+  char pad1_[CHI_CACHE_LINE_SIZE];
+  alignas(CHI_CACHE_LINE_SIZE)
+      hipc::atomic<hshm::min_u64> emplace_count_ = 0; /**< In-flight emplaces */
+  char pad2_[CHI_CACHE_LINE_SIZE];
+  alignas(CHI_CACHE_LINE_SIZE)
+      hipc::atomic<hshm::min_u64> pop_count_ = 0; /**< In-flight ingests */
+  char pad3_[CHI_CACHE_LINE_SIZE]; /**< Separates the next lane */
 
  public:
   /**====================================
@@ -269,10 +291,33 @@ class Lane : public hipc::ShmContainer {
   /** Max depth of queue */
   HSHM_INLINE_CROSS_FUN
   size_t GetDepth() { return queue_.GetDepth(); }
+
+  /**
+   * Migrate the entries of this lane into a new ring of size \a depth.
+   * The lane must be plugged for both emplace and pop.
+   * */
+  HSHM_CROSS_FUN
+  void Resize(size_t depth) {
+    if (depth <= GetDepth()) {
+      return;
+    }
+    hipc::mpsc_queue<LaneData, CHI_ALLOC_T> queue(queue_.GetCtxAllocator(),
+                                                  depth);
+    queue.flags_ = queue_.flags_;
+    LaneData entry;
+    while (!queue_.pop(entry).IsNull()) {
+      queue.emplace(entry);
+    }
+    queue_ = std::move(queue);
+  }
 };
 
-/** Prioritization of different lanes in the queue */
-struct LaneGroup : public PriorityInfo, public hipc::ShmContainer {
+/**
+ * Prioritization of different lanes in the queue.
+ * Read-mostly; aligned so neighboring groups never share a line.
+ * */
+struct alignas(CHI_CACHE_LINE_SIZE) LaneGroup : public PriorityInfo,
+                                                public hipc::ShmContainer {
   u32 prio_;          /**< The priority of the lane group */
   u32 num_scheduled_; /**< The number of lanes currently scheduled on workers */
   chi::ipc::vector<Lane> lanes_; /**< The lanes of the queue */
@@ -427,9 +472,10 @@ struct MultiQueue : public hipc::ShmContainer {
     for (const PriorityInfo &prio_info : prios) {
       groups_.replace(groups_.begin() + prio_info.prio_, prio_info);
       LaneGroup &lane_group = groups_[prio_info.prio_];
-      // Initialize lanes
+      // Initialize lanes. All max_lanes_ are created up-front so that
+      // workers can be assigned to them once. Only num_lanes_ are used.
       lane_group.lanes_.reserve(prio_info.max_lanes_);
-      for (LaneId lane_id = 0; lane_id < lane_group.num_lanes_; ++lane_id) {
+      for (LaneId lane_id = 0; lane_id < lane_group.max_lanes_; ++lane_id) {
         lane_group.lanes_.emplace_back(lane_group.depth_,
                                        QueueId{prio_info.prio_, lane_id});
         Lane &lane = lane_group.lanes_.back();
@@ -532,52 +578,170 @@ struct MultiQueue : public hipc::ShmContainer {
   /** Emplace a SHM pointer to a task */
   HSHM_INLINE_CROSS_FUN
   bool Emplace(u32 prio, u32 lane_hash, const LaneData &data) {
-    if (IsEmplacePlugged()) {
-      WaitForEmplacePlug();
-    }
-    LaneGroup &lane_group = GetGroup(prio);
-    LaneId lane_id = lane_hash % lane_group.num_lanes_;
-    Lane &lane = GetLane(lane_group, lane_id);
+    Lane &lane = BeginEmplace(prio, lane_hash);
     hshm::qtok_t ret = lane.emplace(data);
+    EndEmplace(lane);
     return !ret.IsNull();
   }
 
   /**
-   * Change the number of active lanes
+   * Starting from the lane of \a lane_hash, find the first lane that
+   * is not full. Falls back to \a lane_hash if every lane is full.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  u32 GetSpillLaneHash(u32 prio, u32 lane_hash) {
+    LaneGroup &lane_group = GetGroup(prio);
+    u32 num_lanes = lane_group.num_lanes_;
+    for (u32 i = 0; i < num_lanes; ++i) {
+      Lane &lane = GetLane(lane_group, (lane_hash + i) % num_lanes);
+      if (lane.GetSize() < lane.GetDepth()) {
+        return lane_hash + i;
+      }
+    }
+    return lane_hash;
+  }
+
+  /**
+   * Select a lane and register an in-flight emplace on it.
+   * Waits while the queue is plugged for resize.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  Lane &BeginEmplace(u32 prio, u32 lane_hash) {
+    while (true) {
+      if (IsEmplacePlugged()) {
+        WaitForEmplacePlug();
+      }
+      LaneGroup &lane_group = GetGroup(prio);
+      LaneId lane_id = lane_hash % lane_group.num_lanes_;
+      Lane &lane = GetLane(lane_group, lane_id);
+      lane.emplace_count_ += 1;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!IsEmplacePlugged()) {
+        return lane;
+      }
+      lane.emplace_count_ -= 1;
+    }
+  }
+
+  /** Mark an in-flight emplace as complete */
+  HSHM_INLINE_CROSS_FUN
+  void EndEmplace(Lane &lane) { lane.emplace_count_ -= 1; }
+
+  /** Register the consumer of a lane. False if pops are plugged. */
+  HSHM_INLINE_CROSS_FUN
+  bool BeginPop(Lane &lane) {
+    lane.pop_count_ += 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (IsPopPlugged()) {
+      lane.pop_count_ -= 1;
+      return false;
+    }
+    return true;
+  }
+
+  /** Mark the consumer of a lane as idle */
+  HSHM_INLINE_CROSS_FUN
+  void EndPop(Lane &lane) { lane.pop_count_ -= 1; }
+
+  /**
+   * Change the number of active lanes and the depth of each lane of
+   * one priority. Lanes can be grown up to max_lanes_. Shrinking only
+   * stops new emplaces into the trailing lanes; workers continue to
+   * drain them.
    * This assumes that PlugForResize and UnplugForResize are called externally.
    * */
-  void Resize(u32 num_lanes) {}
+  HSHM_CROSS_FUN
+  void Resize(u32 prio, u32 num_lanes, u32 depth) {
+    LaneGroup &lane_group = GetGroup(prio);
+    if (depth > lane_group.depth_) {
+      lane_group.depth_ = depth;
+      for (Lane &lane : lane_group.lanes_) {
+        lane.Resize(depth);
+      }
+    }
+    lane_group.num_lanes_ = std::min(num_lanes, lane_group.max_lanes_);
+    if (lane_group.num_lanes_ == 0) {
+      lane_group.num_lanes_ = 1;
+    }
+  }
 
-  /** Begin plugging the queue for resize */
-  HSHM_INLINE_CROSS_FUN bool PlugForResize() { return true; }
+  /**
+   * Change the number of active lanes of one priority
+   * This assumes that PlugForResize and UnplugForResize are called externally.
+   * */
+  HSHM_CROSS_FUN
+  void Resize(u32 prio, u32 num_lanes) { Resize(prio, num_lanes, 0); }
 
-  /** Begin plugging the queue for update tasks */
-  HSHM_INLINE_CROSS_FUN bool PlugForUpdateTask() { return true; }
+  /**
+   * Begin plugging the queue for resize. New emplaces block immediately,
+   * in-flight emplaces are drained, and then pops are plugged.
+   * Returns true once the queue is fully plugged. Call repeatedly.
+   * */
+  HSHM_INLINE_CROSS_FUN bool PlugForResize() {
+    flags_.SetBits(QUEUE_RESIZE);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (LaneGroup &lane_group : groups_) {
+      for (Lane &lane : lane_group.lanes_) {
+        if (lane.emplace_count_.load() > 0) {
+          return false;
+        }
+      }
+    }
+    return PlugForUpdateTask();
+  }
+
+  /**
+   * Begin plugging the queue for update tasks. Pops are stopped and
+   * in-flight ingests are drained. Returns true once the queue is plugged.
+   * Call repeatedly.
+   * */
+  HSHM_INLINE_CROSS_FUN bool PlugForUpdateTask() {
+    flags_.SetBits(QUEUE_UPDATE);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (LaneGroup &lane_group : groups_) {
+      for (Lane &lane : lane_group.lanes_) {
+        if (lane.pop_count_.load() > 0) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
 
   /** Check if emplace operations are plugged */
   HSHM_INLINE_CROSS_FUN bool IsEmplacePlugged() {
     return flags_.Any(QUEUE_RESIZE);
   }
 
-  /** Check if pop operations are plugged */
-  HSHM_INLINE_CROSS_FUN bool IsPopPlugged() {
-    return flags_.Any(QUEUE_UPDATE | QUEUE_RESIZE);
-  }
+  /**
+   * Check if pop operations are plugged.
+   * Pops continue during the first phase of a resize so that emplaces
+   * blocked on a full lane can complete.
+   * */
+  HSHM_INLINE_CROSS_FUN bool IsPopPlugged() { return flags_.Any(QUEUE_UPDATE); }
 
   /** Wait for emplace plug to complete */
   HSHM_INLINE_CROSS_FUN
   void WaitForEmplacePlug() {
-    // NOTE(llogan): will this infinite loop due to CPU caching?
-    while (flags_.Any(QUEUE_UPDATE)) {
+    while (flags_.Any(QUEUE_RESIZE)) {
       HSHM_THREAD_MODEL->Yield();
+      std::atomic_thread_fence(std::memory_order_seq_cst);
     }
   }
 
   /** Enable emplace & pop */
-  HSHM_INLINE void UnplugForResize() { flags_.UnsetBits(QUEUE_RESIZE); }
+  HSHM_INLINE void UnplugForResize() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    flags_.UnsetBits(QUEUE_RESIZE | QUEUE_UPDATE);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
 
   /** Enable pop */
-  HSHM_INLINE void UnplugForUpdateTask() { flags_.UnsetBits(QUEUE_UPDATE); }
+  HSHM_INLINE void UnplugForUpdateTask() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    flags_.UnsetBits(QUEUE_UPDATE);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
 };
 
 }  // namespace chi::ingress
@@ -77,6 +77,14 @@ class QueueManager {
       QueueManagerShm &shm, const QueueId &id,
       const std::vector<ingress::PriorityInfo> &queue_info);
 
+  /**
+   * Grow the depth and change the number of lanes of one priority of a
+   * queue online. When called from a task running on a worker, pass the
+   * task so the worker keeps polling while the queue drains.
+   * */
+  void ResizeQueue(const QueueId &id, TaskPrio prio, u32 num_lanes, u32 depth,
+                   Task *task = nullptr);
+
   /**
    * Remove a queue
    *
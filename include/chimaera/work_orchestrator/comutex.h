@@ -61,7 +61,7 @@ void CoMutex::Unlock() {
     // HILOG(kInfo, "Unlocking task {} (id={}, pool={}, method={})", (void
     // *)task,
     //       task->task_node_, task->pool_, task->method_);
-    CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->rctx_);
+    CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->GetRunContext());
     ++rep_;
   }
   blocked_map_.erase(root_);
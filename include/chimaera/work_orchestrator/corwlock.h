@@ -53,7 +53,7 @@ void CoRwLock::ReadUnlock() {
   COMUTEX_QUEUE_T &blocked = writer_map_[root_];
   for (size_t i = 0; i < blocked.size(); ++i) {
     Task *task = blocked[i].task_;
-    CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->rctx_);
+    CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->GetRunContext());
     ++rep_;
   }
   writer_map_.erase(root_);
@@ -95,7 +95,7 @@ void CoRwLock::WriteUnlock() {
     COMUTEX_QUEUE_T &blocked = writer_map_[root_];
     for (size_t i = 0; i < blocked.size(); ++i) {
       Task *task = blocked[i].task_;
-      CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->rctx_);
+      CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->GetRunContext());
       ++rep_;
     }
     writer_map_.erase(root_);
@@ -103,7 +103,7 @@ void CoRwLock::WriteUnlock() {
     is_read_ = true;
     for (size_t i = 0; i < reader_set_.size(); ++i) {
       Task *task = reader_set_[i].task_;
-      CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->rctx_);
+      CHI_WORK_ORCHESTRATOR->SignalUnblock(task, task->GetRunContext());
       ++rep_;
     }
     reader_set_.clear();
@@ -36,7 +36,7 @@ struct BlockedTask {
   BlockedTask() = default;
 
   BlockedTask(Task *task) : task_(task) {
-    block_count_ = task->rctx_.block_count_;
+    block_count_ = task->block_count_;
   }
 };
 
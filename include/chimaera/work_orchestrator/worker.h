@@ -18,6 +18,7 @@
 #include <queue>
 #include <thread>
 
+#include "chimaera/api/route_table.h"
 #include "chimaera/chimaera_types.h"
 #include "chimaera/module_registry/module_registry.h"
 #include "chimaera/network/rpc_thallium.h"
@@ -145,6 +146,12 @@ class WorkOrchestrator;
 typedef chi::mpsc_ptr_queue<TaskPointer> PrivateTaskQueue;
 typedef chi::mpsc_queue<chi::Lane *> PrivateLaneQueue;
 
+/** A completion waiting for room in its completion queue */
+struct PendingCompletion {
+  hipc::Pointer cq_;   /**< The completion queue */
+  hipc::Pointer task_; /**< The completed task */
+};
+
 class PrivateLaneMultiQueue {
  public:
   PrivateLaneQueue active_[2];
@@ -175,6 +182,7 @@ class PrivateTaskMultiQueue {
  public:
   PrivateTaskQueue queues_[NUM_QUEUES];
   PrivateLaneMultiQueue active_lanes_;
+  RouteHintCache route_hints_; /**< Route hints this worker published */
   size_t id_;
 
  public:
@@ -222,6 +230,10 @@ class PrivateTaskMultiQueue {
   // PushRemoteTask
   HSHM_INLINE
   bool PushRemoteTask(RunContext &rctx, const FullPtr<Task> &task);
+
+  // PushGroupMembers
+  void PushGroupMembers(hipc::Pointer member_p, Container *exec,
+                        ContainerId container_id, chi::Lane *chi_lane);
 };
 
 class Worker {
@@ -254,6 +266,8 @@ class Worker {
   bool do_sampling_ = false; /**< Whether or not to sample */
   size_t monitor_gap_;       /**< Distance between sampling phases */
   size_t monitor_window_;    /** Length of sampling phase */
+  std::vector<PendingCompletion>
+      cq_backlog_; /**< Completions retried until their queues have room */
 
  public:
   /**===============================================================
@@ -335,6 +349,12 @@ class Worker {
   HSHM_INLINE
   size_t PollPrivateLaneMultiQueue(PrivateLaneQueue &queue, bool flushing);
 
+  /** Merge the tasks queued after a task into it */
+  HSHM_INLINE
+  void MergeTasks(chi::Lane *chi_lane, FullPtr<Task> &task,
+                  FullPtr<Task> &next, size_t &max_lane_size,
+                  size_t &done_tasks);
+
   /** Run a task */
   bool RunTask(FullPtr<Task> &task, bool flushing);
 
@@ -343,6 +363,10 @@ class Worker {
   void ExecTask(FullPtr<Task> &task, RunContext &rctx, Container *&exec,
                 ibitfield &props);
 
+  /** Start one run of a long-running task */
+  HSHM_INLINE
+  bool EnterLongRunning(Task *task, RunContext &rctx);
+
   /** Run a task */
   HSHM_INLINE
   void ExecCoroutine(Task *&task, RunContext &rctx);
@@ -354,6 +378,12 @@ class Worker {
   HSHM_INLINE
   void EndTask(Container *exec, FullPtr<Task> task, RunContext &rctx);
 
+  /** Push a completion, or keep it in the backlog if the queue is full */
+  void PushCompletion(const hipc::Pointer &cq_p, const hipc::Pointer &task_p);
+
+  /** Retry the completions that did not fit in their queues */
+  void RetryCompletions();
+
   /**===============================================================
    * Helpers
    * =============================================================== */
@@ -1,5 +1,9 @@
 #include "chimaera/api/chimaera_client.h"
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace chi {
 
 /** Initialize the client (GPU) */
@@ -43,6 +47,8 @@ void Client::ClientInit(const char *server_config_path,
                         const char *client_config_path, bool server) {
   LoadServerConfig(server_config_path);
   LoadClientConfig(client_config_path);
+  thread_affine_lanes_ = client_config_->lane_policy_ == "kThreadAffine";
+  routed_lanes_ = client_config_->lane_policy_ == "kRouted";
   LoadSharedMemory(server);
   CHI_QM->ClientInit(main_alloc_, header_->queue_manager_, header_->node_id_);
   CreateClientOnHostForGpu();
@@ -68,6 +74,10 @@ void Client::LoadSharedMemory(bool server) {
   header_ = main_alloc_->GetCustomHeader<ChiShm>();
   unique_ = &header_->unique_;
   node_id_ = header_->node_id_;
+  task_slab_.Init(main_alloc_, &header_->task_slab_, 0);
+  data_slab_.Init(data_alloc_,
+                  HSHM_MEMORY_MANAGER->Convert<TaskSlabShm>(header_->data_slab_),
+                  1, &header_->data_waitq_);
   RefreshNumGpus();
 
   // Create per-gpu allocator
@@ -95,6 +105,55 @@ void Client::LoadSharedMemoryGpu(const std::string &prefix,
   }
 }
 
+/** Create a shared-memory region for RegisterBuffer */
+RegisteredBuffer Client::CreateBuffer(const std::string &name, size_t size) {
+  RegisteredBuffer buf;
+  // Reserve an id only while below the cap, so a refused registration
+  // does not consume one
+  u32 buf_id = header_->buffer_count_.load();
+  do {
+    if (buf_id >= CHI_MAX_BUFFERS) {
+      HELOG(kError, "Cannot register more than {} buffers", CHI_MAX_BUFFERS);
+      return buf;
+    }
+  } while (!header_->buffer_count_.compare_exchange_weak(buf_id, buf_id + 1));
+  auto mem_mngr = HSHM_MEMORY_MANAGER;
+  hipc::MemoryBackendId backend_id = GetBufferMemBackendId(buf_id);
+  // Leave room for the allocator's metadata
+  mem_mngr->CreateBackend<hipc::PosixShmMmap>(backend_id,
+                                              size + MEGABYTES(1), name);
+  CHI_ALLOC_T *alloc = mem_mngr->CreateAllocator<CHI_ALLOC_T>(
+      backend_id, GetBufferAllocId(buf_id), 0);
+  buf.id_ = buf_id;
+  buf.name_ = name;
+  buf.size_ = size;
+  buf.base_ = alloc->AllocateLocalPtr<char>(HSHM_DEFAULT_MEM_CTX, size);
+  if (buf.IsNull()) {
+    HELOG(kError, "Could not map a buffer of size {}", size);
+  }
+  return buf;
+}
+
+#ifdef CHIMAERA_RUNTIME
+/** Map a client's registered region into the runtime */
+void Client::AttachBuffer(const std::string &name) {
+  HSHM_MEMORY_MANAGER->AttachBackend(hipc::MemoryBackendType::kPosixShmMmap,
+                                     name);
+}
+#endif
+
+/** Sleep until the generation moves past gen */
+void AllocWaitQueue::WaitStd(u32 gen) {
+  syscall(SYS_futex, reinterpret_cast<u32 *>(&gen_), FUTEX_WAIT, gen, nullptr,
+          nullptr, 0);
+}
+
+/** Issue the futex wake */
+void AllocWaitQueue::WakeSlow() {
+  syscall(SYS_futex, reinterpret_cast<u32 *>(&gen_), FUTEX_WAKE, INT32_MAX,
+          nullptr, nullptr, 0);
+}
+
 /** Creates the CHI_CLIENT on the GPU */
 void Client::CreateClientOnHostForGpu() {
   // Get the allocators for the GPUs
@@ -40,7 +40,7 @@ void Runtime::ServerInit(std::string server_config_path) {
   InitSharedMemoryGpu();
   // Create module registry
   CHI_MOD_REGISTRY->ServerInit(server_config_, CHI_RPC->node_id_,
-                               header_->unique_);
+                               header_->pool_unique_);
   CHI_MOD_REGISTRY->RegisterModule("chimaera_admin");
   CHI_MOD_REGISTRY->RegisterModule("worch_queue_round_robin");
   CHI_MOD_REGISTRY->RegisterModule("worch_proc_round_robin");
@@ -70,6 +70,7 @@ void Runtime::ServerInit(std::string server_config_path) {
   CHI_MOD_REGISTRY->CreateContainer("chimaera_admin", "chimaera_admin",
                                     CHI_QM->admin_pool_id_, admin_create_task,
                                     containers);
+  admin_create_task->FreeRunContext();
 
   // Create the work orchestrator queue scheduling library
   PoolId queue_sched_id = CHI_CLIENT->MakePoolId();
@@ -84,6 +85,7 @@ void Runtime::ServerInit(std::string server_config_path) {
   CHI_MOD_REGISTRY->CreateContainer("worch_queue_round_robin",
                                     "worch_queue_round_robin", queue_sched_id,
                                     create_task, containers);
+  create_task->FreeRunContext();
 
   // Create the work orchestrator process scheduling library
   PoolId proc_sched_id = CHI_CLIENT->MakePoolId();
@@ -98,6 +100,7 @@ void Runtime::ServerInit(std::string server_config_path) {
   CHI_MOD_REGISTRY->CreateContainer("worch_proc_round_robin",
                                     "worch_proc_round_robin", proc_sched_id,
                                     create_task, containers);
+  create_task->FreeRunContext();
 
   // Set the work orchestrator queue scheduler
   CHI_ADMIN->SetWorkOrchQueuePolicyRN(
@@ -133,12 +136,21 @@ void Runtime::InitSharedMemory() {
   main_alloc_ = mem_mngr->CreateAllocator<CHI_ALLOC_T>(
       hipc::MemoryBackendId(0), main_alloc_id_, sizeof(ChiShm));
   header_ = main_alloc_->GetCustomHeader<ChiShm>();
+  header_->task_slab_.shm_init();
+  header_->data_waitq_.shm_init();
+  header_->rdata_waitq_.shm_init();
+  header_->route_table_.shm_init();
   mem_mngr->SetDefaultAllocator(main_alloc_);
   // Create separate data allocator
   mem_mngr->CreateBackend<hipc::PosixShmMmap>(
       hipc::MemoryBackendId(1), qm.data_shm_size_, qm.data_shm_name_);
   data_alloc_ = mem_mngr->CreateAllocator<CHI_ALLOC_T>(hipc::MemoryBackendId(1),
                                                        data_alloc_id_, 0);
+  // The free lists of the data slab live with the data they point to
+  FullPtr<TaskSlabShm> data_slab =
+      data_alloc_->NewObjLocal<TaskSlabShm>(HSHM_DEFAULT_MEM_CTX);
+  data_slab->shm_init();
+  header_->data_slab_ = data_slab.shm_;
   // Create separate runtime data allocator
   mem_mngr->CreateBackend<hipc::PosixShmMmap>(
       hipc::MemoryBackendId(2), qm.rdata_shm_size_, qm.rdata_shm_name_);
@@ -153,6 +165,9 @@ void Runtime::InitSharedMemoryGpu() {
   header_->node_id_ = CHI_RPC->node_id_;
   header_->unique_ = 0;
   header_->num_nodes_ = server_config_->rpc_.host_names_.size();
+  header_->buffer_count_ = 0;
+  header_->pool_gen_ = 0;
+  header_->pool_unique_ = 0;
 
   // Create per-gpu allocator
 #ifdef CHIMAERA_ENABLE_CUDA
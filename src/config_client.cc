@@ -27,6 +27,9 @@ void ClientConfig::ParseYAML(YAML::Node &yaml_conf) {
   if (yaml_conf["thread_model"]) {
     thread_model_ = yaml_conf["thread_model"].as<std::string>();
   }
+  if (yaml_conf["lane_policy"]) {
+    lane_policy_ = yaml_conf["lane_policy"].as<std::string>();
+  }
 }
 
 /** Load the default configuration */
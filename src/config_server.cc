@@ -52,6 +52,9 @@ void ServerConfig::ParseQueueManager(YAML::Node yaml_conf) {
   if (yaml_conf["max_lanes"]) {
     queue_manager_.max_containers_pn_ = yaml_conf["max_lanes"].as<size_t>();
   }
+  if (yaml_conf["num_lanes"]) {
+    queue_manager_.num_lanes_ = yaml_conf["num_lanes"].as<size_t>();
+  }
   if (yaml_conf["max_queues"]) {
     queue_manager_.max_queues_ = yaml_conf["max_queues"].as<size_t>();
   }
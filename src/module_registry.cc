@@ -27,35 +27,45 @@ bool ModuleRegistry::CreateContainer(
     return false;
   }
   ModuleInfo &info = it->second;
-  pools_[pool_id].module_ = &info;
+  PoolTable *table = new PoolTable(*pools_.load());
+  PoolInfo &pool = table->pools_[pool_id];
+  pool.id_ = pool_id;
+  pool.module_ = &info;
+  pool.lib_name_ = lib_name;
 
-  // Create partitioned state
-  pools_[pool_id].lib_name_ = lib_name;
-  std::unordered_map<ContainerId, Container *> &states =
-      pools_[pool_id].containers_;
+  // Allocate the partitioned state, publishing the pool once
+  std::vector<Container *> created;
   for (const SubDomainId &container_id : containers) {
     // Don't repeat if state exists
-    if (states.find(container_id.minor_) != states.end()) {
+    if (pool.containers_.count(container_id.minor_)) {
       continue;
     }
-
-    // Allocate the state
     Container *exec = info.new_state_(&pool_id, pool_name);
     if (!exec) {
       HELOG(kError, "Could not create the pool: {}", pool_name);
+      for (Container *unused : created) {
+        delete unused;
+      }
+      delete table;
       return false;
     }
-
-    // Add the state to the registry
     exec->id_ = pool_id;
     exec->name_ = pool_name;
     exec->container_id_ = container_id.minor_;
-    pools_[pool_id].containers_[exec->container_id_] = exec;
+    pool.containers_[exec->container_id_] = exec;
+    created.emplace_back(exec);
+  }
+  PublishPools(table, {});
 
-    // Construct the state
+  // Construct the state
+  for (Container *exec : created) {
+    if (!pools_.load()->Find(pool_id)) {
+      HELOG(kError, "The pool {} was destroyed during creation", pool_name);
+      return false;
+    }
     task->ctx_.id_ = pool_id;
     lock.Unlock();  // May spawn subtask that needs the lock
-    exec->Run(TaskMethod::kCreate, task, task->rctx_);
+    exec->Run(TaskMethod::kCreate, task, task->GetRunContext());
     lock.Lock(0);
     exec->is_created_ = true;
   }
@@ -14,6 +14,12 @@ void QueueManager::ServerInit(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc,
   // Initialize ticket queue (ticket 0 is for admin queue)
   max_queues_ = qm.max_queues_;
   max_containers_pn_ = qm.max_containers_pn_;
+  // Process queues boot with fewer lanes than allocated so that
+  // ResizeQueue can grow them
+  u32 num_lanes = std::min(qm.num_lanes_, qm.max_containers_pn_);
+  if (num_lanes == 0) {
+    num_lanes = qm.max_containers_pn_;
+  }
   // Initialize queue map
   shm.queue_map_.shm_init(alloc);
   queue_map_ = shm.queue_map_.get();
@@ -33,10 +39,10 @@ void QueueManager::ServerInit(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc,
   queue = CreateQueue(
       shm, process_queue_id_,
       {
-          {TaskPrioOpt::kLowLatency, qm.max_containers_pn_,
-           qm.max_containers_pn_, qm.proc_queue_depth_, QUEUE_LOW_LATENCY},
-          {TaskPrioOpt::kHighLatency, qm.max_containers_pn_,
-           qm.max_containers_pn_, qm.proc_queue_depth_, 0},
+          {TaskPrioOpt::kLowLatency, num_lanes, qm.max_containers_pn_,
+           qm.proc_queue_depth_, QUEUE_LOW_LATENCY},
+          {TaskPrioOpt::kHighLatency, num_lanes, qm.max_containers_pn_,
+           qm.proc_queue_depth_, 0},
       });
   queue->flags_.SetBits(QUEUE_READY);
 
@@ -59,10 +65,10 @@ void QueueManager::ServerInit(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc,
     queue = CreateQueue(
         gpu_shm, gpu_queue_id,
         {
-            {TaskPrioOpt::kLowLatency, qm.max_containers_pn_,
-             qm.max_containers_pn_, qm.proc_queue_depth_, QUEUE_LOW_LATENCY},
-            {TaskPrioOpt::kHighLatency, qm.max_containers_pn_,
-             qm.max_containers_pn_, qm.proc_queue_depth_, 0},
+            {TaskPrioOpt::kLowLatency, num_lanes, qm.max_containers_pn_,
+             qm.proc_queue_depth_, QUEUE_LOW_LATENCY},
+            {TaskPrioOpt::kHighLatency, num_lanes, qm.max_containers_pn_,
+             qm.proc_queue_depth_, 0},
         });
     queue->flags_.SetBits(QUEUE_READY);
   }
@@ -85,6 +91,27 @@ ingress::MultiQueue *QueueManager::CreateQueue(
   shm.queue_map_->replace(shm.queue_map_->begin() + id.unique_, id, queue_info);
   return queue;
 }
+
+/** Grow the depth and change the number of lanes of a queue online */
+void QueueManager::ResizeQueue(const QueueId &id, TaskPrio prio,
+                               u32 num_lanes, u32 depth, Task *task) {
+  ingress::MultiQueue *queue = GetQueue(id);
+  if (queue->id_.IsNull()) {
+    HELOG(kError, "Cannot resize null queue {}", id);
+    return;
+  }
+  while (!queue->PlugForResize()) {
+    if (task) {
+      task->Yield();
+    } else {
+      HSHM_THREAD_MODEL->Yield();
+    }
+  }
+  queue->Resize(prio, num_lanes, depth);
+  queue->UnplugForResize();
+  HILOG(kInfo, "Resized priority {} of queue {} to {} lanes of depth {}",
+        prio, id, num_lanes, depth);
+}
 #endif
 
 }  // namespace chi
\ No newline at end of file
@@ -25,8 +25,9 @@ void ReinforceWorker::Reinforce() {
   CHI_WORK_ORCHESTRATOR->ImportModule("chimaera_monitor");
   std::vector<Load> loads = CHI_WORK_ORCHESTRATOR->CalculateLoad();
   RunContext rctx;
-  for (auto pool_it = CHI_MOD_REGISTRY->pools_.begin();
-       pool_it != CHI_MOD_REGISTRY->pools_.end(); ++pool_it) {
+  ModuleRegistry::ScopedPoolRead read(*CHI_MOD_REGISTRY);
+  for (auto pool_it = read.table_->pools_.begin();
+       pool_it != read.table_->pools_.end(); ++pool_it) {
     for (auto cont_it = pool_it->second.containers_.begin();
          cont_it != pool_it->second.containers_.end(); ++cont_it) {
       Container *container = cont_it->second;
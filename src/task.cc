@@ -2,6 +2,10 @@
 // Created by llogan on 7/22/24.
 //
 #include "chimaera/module_registry/task.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #ifdef CHIMAERA_RUNTIME
 #include <thallium.hpp>
 
@@ -19,6 +23,9 @@ void Task::YieldArgo() {
 
 HSHM_CROSS_FUN
 void Task::Wait(chi::IntFlag flags) {
+  if (HasCompletionQueue()) {
+    HELOG(kFatal, "Tasks bound to a completion queue are reaped, not waited");
+  }
 #if defined(CHIMAERA_RUNTIME) and defined(HSHM_IS_HOST)
   Task *parent_task = CHI_CUR_TASK;
   if (this != parent_task) {
@@ -26,9 +33,45 @@ void Task::Wait(chi::IntFlag flags) {
   } else {
     SpinWaitCo(flags);
   }
+#elif defined(HSHM_IS_HOST)
+  if (flags == TASK_COMPLETE) {
+    FutexWait();
+  } else {
+    SpinWait(flags);
+  }
 #else
   SpinWait(flags);
 #endif
 }
 
+/** Number of polls before a client goes to sleep */
+static const size_t kFutexSpinCount = 4096;
+
+void Task::FutexWait() {
+  for (size_t i = 0; i < kFutexSpinCount; ++i) {
+    std::atomic_thread_fence(std::memory_order::memory_order_seq_cst);
+    if (IsComplete()) {
+      return;
+    }
+  }
+  // Register as a waiter. If EndTask already claimed the word, completion
+  // is about to be published and there is nobody to wake us.
+  u32 idle = kTaskFutexIdle;
+  if (futex_.compare_exchange_strong(idle, kTaskFutexSleeping)) {
+    // EndTask moves the word off kTaskFutexSleeping before waking, so a
+    // wake that races with FUTEX_WAIT makes the wait return immediately.
+    while (futex_.load() == kTaskFutexSleeping) {
+      syscall(SYS_futex, reinterpret_cast<u32 *>(&futex_), FUTEX_WAIT,
+              kTaskFutexSleeping, nullptr, nullptr, 0);
+    }
+  }
+  SpinWait();
+  // The runtime no longer touches the word once the task is complete
+  futex_.store(kTaskFutexIdle);
+}
+
+void Task::WakeWaiterSlow(u32 *addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
 }  // namespace chi
\ No newline at end of file
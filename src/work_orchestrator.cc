@@ -102,7 +102,9 @@ void WorkOrchestrator::AssignQueueMap(
       continue;
     }
     for (ingress::LaneGroup &lane_group : queue.groups_) {
-      u32 num_lanes = lane_group.num_lanes_;
+      // Schedule every allocated lane so that MultiQueue::Resize can grow
+      // num_lanes_ without touching the workers
+      u32 num_lanes = lane_group.lanes_.size();
       for (LaneId lane_id = lane_group.num_scheduled_; lane_id < num_lanes;
            ++lane_id) {
         WorkerId worker_id;
@@ -123,6 +125,10 @@ void WorkOrchestrator::AssignQueueMap(
         }
         ingress::Lane &lane = lane_group.GetLane(lane_id);
         lane.worker_id_ = worker_id;
+        if (queue.id_ == CHI_QM->process_queue_id_ &&
+            lane_group.IsLowLatency()) {
+          CHI_CLIENT->header_->route_table_.SetWorkerLane(worker_id, lane_id);
+        }
       }
       lane_group.num_scheduled_ = num_lanes;
     }
@@ -233,7 +239,7 @@ std::vector<Load> WorkOrchestrator::CalculateLoad() {
 
 /** Unblock a task */
 void WorkOrchestrator::SignalUnblock(Task *task, RunContext &rctx) {
-  ssize_t count = rctx.block_count_.fetch_sub(1) - 1;
+  ssize_t count = task->block_count_.fetch_sub(1) - 1;
   if (count == 0) {
     rctx.route_lane_->push<false>(FullPtr<Task>(task));
   } else if (count < 0) {
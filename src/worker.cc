@@ -41,7 +41,7 @@ bool PrivateTaskMultiQueue::push(const FullPtr<Task> &task) {
     task->UnsetRemote();
   }
 #endif
-  RunContext &rctx = task->rctx_;
+  RunContext &rctx = task->GetRunContext();
   if (task->IsTriggerComplete()) {
     return PushCompletedTask(rctx, task);
   }
@@ -67,7 +67,7 @@ bool PrivateTaskMultiQueue::PushCompletedTask(RunContext &rctx,
                                               const FullPtr<Task> &task) {
   HLOG(kDebug, kRemoteQueue, "[TASK_CHECK] Completing {}", task.ptr_);
   Container *exec = CHI_MOD_REGISTRY->GetStaticContainer(task->pool_);
-  CHI_CUR_WORKER->EndTask(exec, task, task->rctx_);
+  CHI_CUR_WORKER->EndTask(exec, task, rctx);
   return true;
 }
 
@@ -75,8 +75,9 @@ bool PrivateTaskMultiQueue::PushCompletedTask(RunContext &rctx,
 HSHM_INLINE
 bool PrivateTaskMultiQueue::PushRoutedTask(RunContext &rctx,
                                            const FullPtr<Task> &task) {
-  Container *exec =
-      CHI_MOD_REGISTRY->GetContainer(task->pool_, rctx.route_container_id_);
+  ModuleRegistry::ScopedPoolRead read(*CHI_MOD_REGISTRY);
+  Container *exec = CHI_MOD_REGISTRY->GetContainer(read, task->pool_,
+                                                   rctx.route_container_id_);
   if (!exec || !exec->is_created_) {
     return !GetFail().push(task).IsNull();
   }
@@ -100,22 +101,47 @@ bool PrivateTaskMultiQueue::PushLocalTask(const DomainQuery &res_query,
   }
   // Determine the lane the task should map to within container
   ContainerId container_id = res_query.sel_.id_;
-  Container *exec = CHI_MOD_REGISTRY->GetContainer(task->pool_, container_id);
+  ModuleRegistry::ScopedPoolRead read(*CHI_MOD_REGISTRY);
+  Container *exec =
+      CHI_MOD_REGISTRY->GetContainer(read, task->pool_, container_id);
   if (!exec || !exec->is_created_) {
     // If the container doesn't exist, it's probably going to get created.
     // Put in the failed queue.
     return !GetFail().push(task).IsNull();
   }
+  // Park the task while its container is quiesced for an upgrade
+  ContainerQuiesce *quiesce = exec->quiesce_.get();
+  if (!quiesce->Admit(task)) {
+    return true;
+  }
+  // An upgrade may have swapped the container since it was looked up.
+  // The old container is freed after this read, so route again.
+  if (read.IsStale()) {
+    quiesce->Revoke(task);
+    return PushLocalTask(res_query, rctx, task);
+  }
   // Find the lane
   chi::Lane *chi_lane = exec->MapTaskToLane(task.ptr_);
   rctx.exec_ = exec;
+  rctx.quiesce_ = quiesce;
+  rctx.quiesce_ver_ = quiesce->version_.load();
+  rctx.run_fun_ = exec->GetRunFun(task->method_);
   rctx.route_container_id_ = container_id;
   rctx.route_lane_ = chi_lane;
   rctx.worker_id_ = chi_lane->worker_id_;
   task->SetRouted();
+  u64 route_key = RouteTable::GetKey(task->pool_, task->dom_query_);
+  if (route_hints_.Update(route_key, chi_lane->worker_id_)) {
+    CHI_CLIENT->header_->route_table_.Publish(route_key, chi_lane->worker_id_);
+  }
+  CHI_TRACE(kIngest, task->task_node_);
+  hipc::Pointer members = task->TakeGroupMembers();
   chi_lane->push<false>(task);
   HLOG(kDebug, kWorkerDebug, "[TASK_CHECK] (node {}) Pushing task {}",
        CHI_CLIENT->node_id_, (void *)task.ptr_);
+  if (!members.IsNull()) {
+    PushGroupMembers(members, exec, container_id, chi_lane);
+  }
   return true;
 }
 
@@ -125,13 +151,47 @@ bool PrivateTaskMultiQueue::PushRemoteTask(RunContext &rctx,
                                            const FullPtr<Task> &task) {
   HLOG(kDebug, kWorkerDebug, "[TASK_CHECK] (node {}) Remoting task {}",
        CHI_CLIENT->node_id_, (void *)task.ptr_);
+  hipc::Pointer members = task->TakeGroupMembers();
   // CASE 6: The task is remote to this machine, put in the remote queue.
   CHI_REMOTE_QUEUE->AsyncClientPushSubmitBase(
       HSHM_DEFAULT_MEM_CTX, nullptr, task->task_node_ + 1,
       DomainQuery::GetDirectId(SubDomainId::kGlobalContainers, 1), task.ptr_);
+  if (!members.IsNull()) {
+    PushGroupMembers(members, nullptr, 0, nullptr);
+  }
   return true;
 }
 
+/**
+ * Route the rest of a task group onto the leader's lane, so the group runs
+ * consecutively on one worker. If the leader was remoted (no lane), the
+ * members are routed individually; group completion is tracked either way.
+ * */
+void PrivateTaskMultiQueue::PushGroupMembers(hipc::Pointer member_p,
+                                             Container *exec,
+                                             ContainerId container_id,
+                                             chi::Lane *chi_lane) {
+  while (!member_p.IsNull()) {
+    FullPtr<Task> member(member_p);
+    member_p = member->TakeGroupMembers();
+    if (!chi_lane) {
+      push(member);
+      continue;
+    }
+    RunContext &rctx = member->GetRunContext();
+    rctx.exec_ = exec;
+    rctx.quiesce_ = exec->quiesce_.get();
+    rctx.quiesce_->AdmitMember(member);
+    rctx.quiesce_ver_ = rctx.quiesce_->version_.load();
+    rctx.run_fun_ = exec->GetRunFun(member->method_);
+    rctx.route_container_id_ = container_id;
+    rctx.route_lane_ = chi_lane;
+    rctx.worker_id_ = chi_lane->worker_id_;
+    member->SetRouted();
+    chi_lane->push<false>(member);
+  }
+}
+
 /**===============================================================
  * Lanes
  * =============================================================== */
@@ -326,6 +386,9 @@ void Worker::Run(bool flushing) {
   }
   PollPrivateLaneMultiQueue(active_.active_lanes_.GetHighLatency(), flushing);
   PollTempQueue<false>(active_.GetFail(), flushing);
+  if (!cq_backlog_.empty()) {
+    RetryCompletions();
+  }
 }
 
 /** Ingest all process lanes */
@@ -341,6 +404,9 @@ HSHM_INLINE
 void Worker::IngestLane(IngressEntry &lane_info) {
   // Ingest tasks from the ingress queues
   ingress::Lane *&ig_lane = lane_info.lane_;
+  if (!lane_info.queue_->BeginPop(*ig_lane)) {
+    return;
+  }
   ingress::LaneData entry;
   while (true) {
     if (ig_lane->pop(entry).IsNull()) {
@@ -349,6 +415,7 @@ void Worker::IngestLane(IngressEntry &lane_info) {
     FullPtr<Task> task(entry);
     active_.push(task);
   }
+  lane_info.queue_->EndPop(*ig_lane);
 }
 
 /** Poll the set of tasks in the private queue */
@@ -405,12 +472,19 @@ size_t Worker::PollPrivateLaneMultiQueue(PrivateLaneQueue &lanes,
         HLOG(kDebug, kWorkerDebug, "Lane has no tasks {}", chi_lane);
       }
       size_t done_tasks = 0;
+      FullPtr<Task> next;
       for (; max_lane_size > 0; --max_lane_size) {
         FullPtr<Task> task;
-        if (chi_lane->pop(task).IsNull()) {
+        if (next.ptr_) {
+          task = next;
+          next.ptr_ = nullptr;
+        } else if (chi_lane->pop(task).IsNull()) {
           HLOG(kDebug, kWorkerDebug, "Lane has no tasks {}", chi_lane);
           break;
         }
+        if (task->IsMergeable()) {
+          MergeTasks(chi_lane, task, next, max_lane_size, done_tasks);
+        }
         bool pushback = RunTask(task, flushing);
         if (pushback) {
           chi_lane->push<true>(task);
@@ -419,6 +493,9 @@ size_t Worker::PollPrivateLaneMultiQueue(PrivateLaneQueue &lanes,
         }
         ++work;
       }
+      if (next.ptr_) {
+        chi_lane->push<true>(next);
+      }
       // If the lane still has tasks, push it back
       size_t after_size = chi_lane->pop_prep(done_tasks);
       if (after_size > 0) {
@@ -436,6 +513,35 @@ size_t Worker::PollPrivateLaneMultiQueue(PrivateLaneQueue &lanes,
   return work;
 }
 
+/** Merge the tasks queued after a task into it */
+HSHM_INLINE
+void Worker::MergeTasks(chi::Lane *chi_lane, FullPtr<Task> &task,
+                        FullPtr<Task> &next, size_t &max_lane_size,
+                        size_t &done_tasks) {
+  if (task->IsStarted() || task->IsLongRunning() ||
+      task->IsTriggerComplete()) {
+    return;
+  }
+  RunContext &rctx = task->GetRunContext();
+  while (max_lane_size > 1) {
+    if (chi_lane->pop(next).IsNull()) {
+      next.ptr_ = nullptr;
+      return;
+    }
+    // A task that can't merge is run next, preserving lane order
+    if (!next->IsMergeable() || next->pool_ != task->pool_ ||
+        next->method_ != task->method_ || next->IsStarted() ||
+        next->IsLongRunning() || next->IsTriggerComplete() ||
+        !rctx.exec_->Merge(task->method_, task.ptr_, next.ptr_)) {
+      return;
+    }
+    rctx.merged_.emplace_back(next);
+    next.ptr_ = nullptr;
+    --max_lane_size;
+    ++done_tasks;
+  }
+}
+
 /** Run a task */
 bool Worker::RunTask(FullPtr<Task> &task, bool flushing) {
 #ifdef HSHM_DEBUG
@@ -443,10 +549,13 @@ bool Worker::RunTask(FullPtr<Task> &task, bool flushing) {
     HLOG(kDebug, kWorkerDebug, "");
   }
 #endif
+  if (!task->IsLongRunning()) {
+    CHI_TRACE(kRun, task->task_node_);
+  }
   // Get task properties
   ibitfield props = GetTaskProperties(task.ptr_, flushing);
   // Pack runtime context
-  RunContext &rctx = task->rctx_;
+  RunContext &rctx = task->GetRunContext();
   rctx.worker_props_ = props;
   rctx.flush_ = &flush_;
   // Run the task
@@ -494,8 +603,38 @@ void Worker::ExecTask(FullPtr<Task> &task, RunContext &rctx, Container *&exec,
       flush_.count_ += 1;
     }
   }
+  // Hold back long-running tasks while their container is quiesced
+  bool is_run = task->IsLongRunning() && rctx.quiesce_ && !task->IsStarted();
+  if (is_run && !EnterLongRunning(task.ptr_, rctx)) {
+    return;
+  }
   // Execute + monitor the task
   ExecCoroutine(task.ptr_, rctx);
+  if (is_run && !task->IsStarted()) {
+    rctx.quiesce_->Release();
+  }
+}
+
+/**
+ * Start one run of a long-running task. The run is counted as in flight
+ * on the container. After an upgrade, the task moves to the new container.
+ * */
+HSHM_INLINE
+bool Worker::EnterLongRunning(Task *task, RunContext &rctx) {
+  ContainerQuiesce *quiesce = rctx.quiesce_;
+  if (!quiesce->EnterRun()) {
+    return false;
+  }
+  u64 version = quiesce->version_.load();
+  if (rctx.quiesce_ver_ != version) {
+    // The run is counted, so the new container outlives the read
+    ModuleRegistry::ScopedPoolRead read(*CHI_MOD_REGISTRY);
+    rctx.exec_ = CHI_MOD_REGISTRY->GetContainer(read, task->pool_,
+                                                rctx.route_container_id_);
+    rctx.run_fun_ = rctx.exec_->GetRunFun(task->method_);
+    rctx.quiesce_ver_ = version;
+  }
+  return true;
 }
 
 /** Run a task */
@@ -529,7 +668,11 @@ void Worker::CoroutineEntry(bctx::transfer_t t) {
     HELOG(kFatal, "Lane is null, should never happen");
   }
   rctx.jmp_ = t;
-  exec->Run(task->method_, task, rctx);
+  if (rctx.run_fun_) {
+    rctx.run_fun_(exec, task, rctx);
+  } else {
+    exec->Run(task->method_, task, rctx);
+  }
   task->UnsetStarted();
   task->BaseYield();
 }
@@ -537,22 +680,102 @@ void Worker::CoroutineEntry(bctx::transfer_t t) {
 /** Free a task when it is no longer needed */
 HSHM_INLINE
 void Worker::EndTask(Container *exec, FullPtr<Task> task, RunContext &rctx) {
+  if (rctx.quiesce_) {
+    if (!task->IsLongRunning()) {
+      rctx.quiesce_->Release();
+    }
+    rctx.quiesce_ = nullptr;
+  }
+  if (!rctx.merged_.empty()) {
+    // Fan the results out to the tasks merged into this one
+    for (FullPtr<Task> &merged : rctx.merged_) {
+      rctx.exec_->MergeEnd(task->method_, task.ptr_, merged.ptr_);
+      EndTask(exec, merged, merged->GetRunContext());
+    }
+    rctx.merged_.clear();
+  }
+  if (task->IsGrouped()) {
+    // Members end silently. The last task of the group to end notifies
+    // on behalf of the whole group through the leader.
+    TaskLinks *links = task->GetLinks();
+    FullPtr<Task> leader(links->grp_leader_);
+    links->grp_leader_ = hipc::Pointer::GetNull();
+    TaskLinks *leader_links = leader->GetLinks();
+    if (task.ptr_ != leader.ptr_) {
+      if (task->HasDagEdges()) {
+        CHI_CLIENT->ReleaseDagEdges(task);
+      }
+      task->FreeRunContext();
+      task->SetComplete();
+      if (leader_links->grp_pending_.fetch_sub(1) == 1) {
+        EndTask(exec, leader, leader->GetRunContext());
+      }
+      return;
+    }
+    if (leader_links->grp_pending_.fetch_sub(1) != 1) {
+      return;
+    }
+  }
   if (task->ShouldSignalUnblock()) {
     Task *pending_to = rctx.pending_to_;
-    CHI_WORK_ORCHESTRATOR->SignalUnblock(pending_to, pending_to->rctx_);
+    CHI_WORK_ORCHESTRATOR->SignalUnblock(pending_to,
+                                         pending_to->GetRunContext());
   }
   if (task->ShouldSignalRemoteComplete()) {
+    ModuleRegistry::ScopedPoolRead read(*CHI_MOD_REGISTRY);
     Container *remote_exec =
-        CHI_MOD_REGISTRY->GetContainer(CHI_REMOTE_QUEUE->id_, 1);
+        CHI_MOD_REGISTRY->GetContainer(read, CHI_REMOTE_QUEUE->id_, 1);
     remote_exec->Run(chi::remote_queue::Method::kServerPushComplete, task.ptr_,
                      rctx);
     return;
   }
+  CHI_TRACE(kEnd, task->task_node_);
+  if (task->HasDagEdges()) {
+    CHI_CLIENT->ReleaseDagEdges(task);
+  }
   if (exec && task->IsFireAndForget()) {
     CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, exec, task.ptr_);
   } else {
-    task->SetComplete();
+    // The owner may free the task as soon as it is complete, so nothing
+    // in the task may be read afterwards. A task with a completion queue
+    // is never waited on and is only freed once reaped, so it can still
+    // be pushed after it completes.
+    hipc::Pointer cq_p = task->cq_;
+    task->FreeRunContext();
+    task->SetCompleteAndWake();
+    if (!cq_p.IsNull()) {
+      PushCompletion(cq_p, task.shm_);
+    }
+  }
+}
+
+/** Push a completion, or keep it in the backlog if the queue is full */
+void Worker::PushCompletion(const hipc::Pointer &cq_p,
+                            const hipc::Pointer &task_p) {
+  // Completions queued behind a full queue keep their order
+  if (cq_backlog_.empty()) {
+    FullPtr<ingress::CompletionQueue> cq(cq_p);
+    if (!cq->emplace(task_p).IsNull()) {
+      return;
+    }
+  }
+  cq_backlog_.emplace_back(PendingCompletion{cq_p, task_p});
+}
+
+/** Retry the completions that did not fit in their queues */
+void Worker::RetryCompletions() {
+  size_t kept = 0;
+  for (size_t i = 0; i < cq_backlog_.size(); ++i) {
+    PendingCompletion &entry = cq_backlog_[i];
+    FullPtr<ingress::CompletionQueue> cq(entry.cq_);
+    if (cq->emplace(entry.task_).IsNull()) {
+      if (kept != i) {
+        cq_backlog_[kept] = entry;
+      }
+      ++kept;
+    }
   }
+  cq_backlog_.resize(kept);
 }
 
 /**===============================================================
@@ -130,5 +130,14 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
     }
   }
 }
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_TASK_NAME_LIB_EXEC_H_
\ No newline at end of file
@@ -68,11 +68,16 @@ class Client : public ModuleClient {
   }
   CHI_TASK_METHODS(Free);
 
-  /** Write to the block device */
+  /**
+   * Write to the block device. Pass TASK_MERGE in \a flags to let the
+   * write merge with adjacent writes queued behind it.
+   * */
   HSHM_INLINE_CROSS_FUN
   void Write(const hipc::MemContext &mctx, const DomainQuery &dom_query,
-             const hipc::Pointer &data, size_t off, size_t size) {
-    FullPtr<WriteTask> task = AsyncWrite(mctx, dom_query, data, off, size);
+             const hipc::Pointer &data, size_t off, size_t size,
+             chi::IntFlag flags = 0) {
+    FullPtr<WriteTask> task =
+        AsyncWrite(mctx, dom_query, data, off, size, flags);
     task.ptr_->Wait();
     CHI_CLIENT->DelTask(mctx, task);
   }
@@ -330,5 +330,51 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
     }
   }
 }
+/** Merge a queued task into the run headed by a task */
+bool Merge(u32 method, Task *task, const Task *next) override {
+  switch (method) {
+    case Method::kWrite: {
+      return chi::CALL_MERGE(
+        reinterpret_cast<WriteTask*>(task), 
+        reinterpret_cast<const WriteTask*>(next));
+    }
+  }
+  return false;
+}
+/** Copy the results of a task to a task merged into it */
+void MergeEnd(u32 method, const Task *task, Task *merged) override {
+  switch (method) {
+    case Method::kWrite: {
+      chi::CALL_MERGE_END(
+        reinterpret_cast<const WriteTask*>(task), 
+        reinterpret_cast<WriteTask*>(merged));
+      break;
+    }
+  }
+}
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kAllocate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Allocate(reinterpret_cast<AllocateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kFree, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Free(reinterpret_cast<FreeTask *>(task), rctx);
+  });
+  SetRunFun(Method::kWrite, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Write(reinterpret_cast<WriteTask *>(task), rctx);
+  });
+  SetRunFun(Method::kRead, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Read(reinterpret_cast<ReadTask *>(task), rctx);
+  });
+  SetRunFun(Method::kPollStats, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->PollStats(reinterpret_cast<PollStatsTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_BDEV_LIB_EXEC_H_
\ No newline at end of file
@@ -5,9 +5,20 @@
 #ifndef CHI_TASKS_TASK_TEMPL_INCLUDE_bdev_bdev_TASKS_H_
 #define CHI_TASKS_TASK_TEMPL_INCLUDE_bdev_bdev_TASKS_H_
 
+#include <limits.h>
+
 #include "chimaera/chimaera_namespace.h"
 #include "chimaera/io/block_allocator.h"
 
+/** Most buffers one merged write covers (the iovec limit of pwritev) */
+#ifdef IOV_MAX
+#define BDEV_MAX_MERGE_IOV IOV_MAX
+#else
+#define BDEV_MAX_MERGE_IOV 1024
+#endif
+/** Most bytes one merged write covers */
+#define BDEV_MAX_MERGE_SIZE MEGABYTES(16)
+
 namespace chi::bdev {
 
 #include "bdev_methods.h"
@@ -98,7 +109,7 @@ struct AllocateTask : public Task, TaskFlags<TF_SRL_SYM> {
 /**
  * A custom task in bdev
  * */
-struct FreeTask : public Task, TaskFlags<TF_SRL_SYM> {
+struct FreeTask : public Task, TaskFlags<TF_SRL_SYM | TF_SRL_POD> {
   IN Block block_;
 
   /** SHM default constructor */
@@ -142,11 +153,14 @@ struct FreeTask : public Task, TaskFlags<TF_SRL_SYM> {
 /**
  * A custom task in bdev
  * */
-struct WriteTask : public Task, TaskFlags<TF_SRL_SYM> {
+struct WriteTask : public Task,
+                   TaskFlags<TF_SRL_SYM | TF_MERGE | TF_CMPGRP> {
   IN hipc::Pointer data_;
   IN size_t size_;
   IN size_t off_;
   OUT bool success_;
+  TEMP u32 merge_count_ = 0;   /**< Writes in the run this task heads */
+  TEMP size_t merge_size_ = 0; /**< Bytes in the run this task heads */
 
   /** SHM default constructor */
   HSHM_INLINE_CROSS_FUN explicit WriteTask(
@@ -157,14 +171,15 @@ struct WriteTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN explicit WriteTask(
       const hipc::CtxAllocator<CHI_ALLOC_T> &alloc, const TaskNode &task_node,
       const PoolId &pool_id, const DomainQuery &dom_query,
-      const hipc::Pointer &data, size_t off, size_t size)
+      const hipc::Pointer &data, size_t off, size_t size,
+      chi::IntFlag flags = 0)
       : Task(alloc) {
     // Initialize task
     task_node_ = task_node;
     prio_ = TaskPrioOpt::kLowLatency;
     pool_ = pool_id;
     method_ = Method::kWrite;
-    task_flags_.SetBits(0);
+    task_flags_.SetBits(flags);
     dom_query_ = dom_query;
 
     // Custom params
@@ -184,11 +199,35 @@ struct WriteTask : public Task, TaskFlags<TF_SRL_SYM> {
     }
   }
 
+  /**
+   * Merge a write that starts where the run headed by this task ends.
+   * A run stops at BDEV_MAX_MERGE_IOV buffers or BDEV_MAX_MERGE_SIZE bytes.
+   * */
+  HSHM_INLINE_CROSS_FUN
+  bool Merge(const WriteTask &next) {
+    if (merge_count_ == 0) {
+      merge_count_ = 1;
+      merge_size_ = size_;
+    }
+    if (next.off_ != off_ + merge_size_ ||
+        merge_count_ >= BDEV_MAX_MERGE_IOV ||
+        merge_size_ + next.size_ > BDEV_MAX_MERGE_SIZE) {
+      return false;
+    }
+    merge_count_ += 1;
+    merge_size_ += next.size_;
+    return true;
+  }
+
+  /** Copy the result of the merged write */
+  HSHM_INLINE_CROSS_FUN
+  void MergeEnd(const WriteTask &task) { success_ = task.success_; }
+
   /** (De)serialize message call */
   template <typename Ar>
   HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
     ar.bulk(DT_WRITE, data_, size_);
-    ar(off_);
+    ar.pod(off_);
   }
 
   /** (De)serialize message return */
@@ -201,7 +240,7 @@ struct WriteTask : public Task, TaskFlags<TF_SRL_SYM> {
 /**
  * A custom task in bdev
  * */
-struct ReadTask : public Task, TaskFlags<TF_SRL_SYM> {
+struct ReadTask : public Task, TaskFlags<TF_SRL_SYM | TF_CMPGRP> {
   IN hipc::Pointer data_;
   IN size_t size_;
   IN size_t off_;
@@ -248,7 +287,7 @@ struct ReadTask : public Task, TaskFlags<TF_SRL_SYM> {
   template <typename Ar>
   HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
     ar.bulk(DT_EXPOSE, data_, size_);
-    ar(size_, off_);
+    ar.pod(size_, off_);
   }
 
   /** (De)serialize message return */
@@ -12,6 +12,8 @@
 
 #include "bdev/bdev.h"
 
+#include <sys/uio.h>
+
 #include "chimaera/api/chimaera_runtime.h"
 #include "chimaera/monitor/monitor.h"
 #include "chimaera_admin/chimaera_admin.h"
@@ -187,6 +189,10 @@ class Server : public Module {
 
   /** Write to the block device */
   void Write(WriteTask *task, RunContext &rctx) {
+    if (!rctx.merged_.empty()) {
+      WriteMerged(task, rctx);
+      return;
+    }
     char *data = HSHM_MEMORY_MANAGER->Convert<char>(task->data_);
     switch (url_.scheme_) {
       case BlockUrl::kFs: {
@@ -208,6 +214,41 @@ class Server : public Module {
       }
     }
   }
+  /** Write a run of adjacent writes merged by the worker */
+  void WriteMerged(WriteTask *task, RunContext &rctx) {
+    std::vector<struct iovec> iov;
+    iov.reserve(rctx.merged_.size() + 1);
+    iov.emplace_back((struct iovec){
+        HSHM_MEMORY_MANAGER->Convert<char>(task->data_), task->size_});
+    size_t size = task->size_;
+    for (FullPtr<Task> &merged : rctx.merged_) {
+      auto *write_task = reinterpret_cast<WriteTask *>(merged.ptr_);
+      iov.emplace_back((struct iovec){
+          HSHM_MEMORY_MANAGER->Convert<char>(write_task->data_),
+          write_task->size_});
+      size += write_task->size_;
+    }
+    switch (url_.scheme_) {
+      case BlockUrl::kFs: {
+        ssize_t ret = pwritev(fd_, iov.data(), iov.size(), task->off_);
+        task->success_ = ret == (ssize_t)size;
+        break;
+      }
+      case BlockUrl::kRam: {
+        char *dst = ram_ + task->off_;
+        for (struct iovec &vec : iov) {
+          memcpy(dst, vec.iov_base, vec.iov_len);
+          dst += vec.iov_len;
+        }
+        task->success_ = true;
+        break;
+      }
+      case BlockUrl::kSpdk: {
+        task->success_ = false;
+        break;
+      }
+    }
+  }
   void MonitorWrite(MonitorModeId mode, WriteTask *task, RunContext &rctx) {
     switch (mode) {
       case MonitorMode::kEstLoad: {
@@ -1,10 +1,110 @@
 #ifndef CHI_TASKS_CHI_ADMIN_CHI_ADMIN_H_
 #define CHI_TASKS_CHI_ADMIN_CHI_ADMIN_H_
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "chimaera_admin_tasks.h"
 
 namespace chi::Admin {
 
+/** A cached pool id lookup: the pool name and the query that resolved it */
+struct PoolIdKey {
+  std::string pool_name_;
+  DomainQuery dom_query_;
+
+  bool operator==(const PoolIdKey &other) const {
+    return pool_name_ == other.pool_name_ && dom_query_ == other.dom_query_;
+  }
+};
+
+/** Hash a PoolIdKey */
+struct PoolIdKeyHash {
+  size_t operator()(const PoolIdKey &key) const {
+    return std::hash<std::string>{}(key.pool_name_) * 31 +
+           hshm::hash<DomainQuery>{}(key.dom_query_);
+  }
+};
+
+/**
+ * Process-local cache of pool ids and domain sizes.
+ * Entries are valid while the runtime's pool generation is unchanged.
+ * Every runtime bumps its generation in shared memory whenever pools or
+ * domains change on any node, so checking the cache never submits a task.
+ * */
+class PoolCache {
+ public:
+  std::mutex lock_;
+  u64 gen_ = 0;
+  std::unordered_map<PoolIdKey, PoolId, PoolIdKeyHash> pool_ids_;
+  std::unordered_map<DomainId, size_t, hshm::hash<DomainId>> dom_sizes_;
+
+ public:
+  /** Get the runtime's pool generation */
+  static u64 GetGeneration() { return CHI_CLIENT->header_->pool_gen_.load(); }
+
+  /** Find a pool id cached for the same name and query */
+  bool GetPoolId(const std::string &pool_name, const DomainQuery &dom_query,
+                 PoolId &id) {
+    std::lock_guard<std::mutex> guard(lock_);
+    Validate(GetGeneration());
+    auto it = pool_ids_.find(PoolIdKey{pool_name, dom_query});
+    if (it == pool_ids_.end()) {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
+  /** Cache a pool id looked up during generation \a gen */
+  void PutPoolId(u64 gen, const std::string &pool_name,
+                 const DomainQuery &dom_query, const PoolId &id) {
+    std::lock_guard<std::mutex> guard(lock_);
+    Validate(GetGeneration());
+    if (gen == gen_ && !id.IsNull()) {
+      pool_ids_[PoolIdKey{pool_name, dom_query}] = id;
+    }
+  }
+
+  /** Find a cached domain size */
+  bool GetDomainSize(const DomainId &dom_id, size_t &dom_size) {
+    std::lock_guard<std::mutex> guard(lock_);
+    Validate(GetGeneration());
+    auto it = dom_sizes_.find(dom_id);
+    if (it == dom_sizes_.end()) {
+      return false;
+    }
+    dom_size = it->second;
+    return true;
+  }
+
+  /** Cache a domain size looked up during generation \a gen */
+  void PutDomainSize(u64 gen, const DomainId &dom_id, size_t dom_size) {
+    std::lock_guard<std::mutex> guard(lock_);
+    Validate(GetGeneration());
+    if (gen == gen_) {
+      dom_sizes_[dom_id] = dom_size;
+    }
+  }
+
+ private:
+  /** Drop all entries if the generation moved */
+  void Validate(u64 gen) {
+    if (gen != gen_) {
+      pool_ids_.clear();
+      dom_sizes_.clear();
+      gen_ = gen;
+    }
+  }
+};
+
+}  // namespace chi::Admin
+
+#define CHI_POOL_CACHE hshm::Singleton<chi::Admin::PoolCache>::GetInstance()
+
+namespace chi::Admin {
+
 /** Create admin requests */
 class Client : public ModuleClient {
  public:
@@ -57,11 +157,22 @@ class Client : public ModuleClient {
   HSHM_INLINE_CROSS_FUN
   PoolId GetPoolId(const hipc::MemContext &mctx, const DomainQuery &dom_query,
                    const chi::string &pool_name) {
+#ifdef HSHM_IS_HOST
+    PoolId new_id;
+    std::string name = pool_name.str();
+    if (CHI_POOL_CACHE->GetPoolId(name, dom_query, new_id)) {
+      return new_id;
+    }
+    u64 gen = PoolCache::GetGeneration();
+#endif
     FullPtr<GetPoolIdTask> task = AsyncGetPoolId(mctx, dom_query, pool_name);
     task->Wait();
-    PoolId new_id = task->id_;
+    PoolId id = task->id_;
     CHI_CLIENT->DelTask(mctx, task);
-    return new_id;
+#ifdef HSHM_IS_HOST
+    CHI_POOL_CACHE->PutPoolId(gen, name, dom_query, id);
+#endif
+    return id;
   }
   CHI_TASK_METHODS(GetPoolId)
 
@@ -167,14 +278,70 @@ class Client : public ModuleClient {
   HSHM_INLINE_CROSS_FUN
   size_t GetDomainSize(const hipc::MemContext &mctx,
                        const DomainQuery &dom_query, const DomainId &dom_id) {
+#ifdef HSHM_IS_HOST
+    size_t dom_size;
+    if (CHI_POOL_CACHE->GetDomainSize(dom_id, dom_size)) {
+      return dom_size;
+    }
+    u64 gen = PoolCache::GetGeneration();
+#endif
     FullPtr<GetDomainSizeTask> task =
         AsyncGetDomainSize(mctx, dom_query, dom_id);
     task->Wait();
-    size_t dom_size = task->dom_size_;
+    size_t size = task->dom_size_;
     CHI_CLIENT->DelTask(mctx, task);
-    return dom_size;
+#ifdef HSHM_IS_HOST
+    CHI_POOL_CACHE->PutDomainSize(gen, dom_id, size);
+#endif
+    return size;
   }
   CHI_TASK_METHODS(GetDomainSize)
+
+  /** Apply domain updates, which also invalidates every PoolCache */
+  HSHM_INLINE
+  void UpdateDomain(const hipc::MemContext &mctx, const DomainQuery &dom_query,
+                    const std::vector<UpdateDomainInfo> &ops) {
+    FullPtr<UpdateDomainTask> task = AsyncUpdateDomain(mctx, dom_query, ops);
+    task->Wait();
+    CHI_CLIENT->DelTask(mctx, task);
+  }
+  CHI_TASK_METHODS(UpdateDomain)
+
+  /**
+   * Create a shared-memory region of \a size bytes and map it into the
+   * local runtime. Tasks can then reference RegisteredBuffer::Get(off)
+   * directly instead of staging data through AllocateBuffer.
+   * */
+  HSHM_INLINE
+  RegisteredBuffer RegisterBuffer(const hipc::MemContext &mctx,
+                                  const std::string &name, size_t size) {
+    RegisteredBuffer buf = CHI_CLIENT->CreateBuffer(name, size);
+    if (buf.IsNull()) {
+      return buf;
+    }
+    FullPtr<RegisterBufferTask> task = AsyncRegisterBuffer(
+        mctx, DomainQuery::GetDirectHash(SubDomainId::kLocalContainers, 0),
+        name);
+    task->Wait();
+    CHI_CLIENT->DelTask(mctx, task);
+    return buf;
+  }
+  CHI_TASK_METHODS(RegisterBuffer)
+
+  /**
+   * Change the number of active lanes and the lane depth of one priority
+   * of a local queue. Tasks in flight are drained before the resize.
+   * */
+  HSHM_INLINE
+  void ResizeQueue(const hipc::MemContext &mctx, const QueueId &queue_id,
+                   u32 queue_prio, u32 num_lanes, u32 depth) {
+    FullPtr<ResizeQueueTask> task = AsyncResizeQueue(
+        mctx, DomainQuery::GetDirectHash(SubDomainId::kLocalContainers, 0),
+        queue_id, queue_prio, num_lanes, depth);
+    task->Wait();
+    CHI_CLIENT->DelTask(mctx, task);
+  }
+  CHI_TASK_METHODS(ResizeQueue)
 };
 
 }  // namespace chi::Admin
@@ -60,6 +60,14 @@ void Run(u32 method, Task *task, RunContext &rctx) override {
       UpdateDomain(reinterpret_cast<UpdateDomainTask *>(task), rctx);
       break;
     }
+    case Method::kRegisterBuffer: {
+      RegisterBuffer(reinterpret_cast<RegisterBufferTask *>(task), rctx);
+      break;
+    }
+    case Method::kResizeQueue: {
+      ResizeQueue(reinterpret_cast<ResizeQueueTask *>(task), rctx);
+      break;
+    }
   }
 }
 /** Execute a task */
@@ -121,6 +129,14 @@ void Monitor(MonitorModeId mode, MethodId method, Task *task, RunContext &rctx)
       MonitorUpdateDomain(mode, reinterpret_cast<UpdateDomainTask *>(task), rctx);
       break;
     }
+    case Method::kRegisterBuffer: {
+      MonitorRegisterBuffer(mode, reinterpret_cast<RegisterBufferTask *>(task), rctx);
+      break;
+    }
+    case Method::kResizeQueue: {
+      MonitorResizeQueue(mode, reinterpret_cast<ResizeQueueTask *>(task), rctx);
+      break;
+    }
   }
 }
 /** Delete a task */
@@ -182,6 +198,14 @@ void Del(const hipc::MemContext &mctx, u32 method, Task *task) override {
       CHI_CLIENT->DelTask<UpdateDomainTask>(mctx, reinterpret_cast<UpdateDomainTask *>(task));
       break;
     }
+    case Method::kRegisterBuffer: {
+      CHI_CLIENT->DelTask<RegisterBufferTask>(mctx, reinterpret_cast<RegisterBufferTask *>(task));
+      break;
+    }
+    case Method::kResizeQueue: {
+      CHI_CLIENT->DelTask<ResizeQueueTask>(mctx, reinterpret_cast<ResizeQueueTask *>(task));
+      break;
+    }
   }
 }
 /** Duplicate a task */
@@ -271,6 +295,18 @@ void CopyStart(u32 method, const Task *orig_task, Task *dup_task, bool deep) ove
         reinterpret_cast<UpdateDomainTask*>(dup_task), deep);
       break;
     }
+    case Method::kRegisterBuffer: {
+      chi::CALL_COPY_START(
+        reinterpret_cast<const RegisterBufferTask*>(orig_task), 
+        reinterpret_cast<RegisterBufferTask*>(dup_task), deep);
+      break;
+    }
+    case Method::kResizeQueue: {
+      chi::CALL_COPY_START(
+        reinterpret_cast<const ResizeQueueTask*>(orig_task), 
+        reinterpret_cast<ResizeQueueTask*>(dup_task), deep);
+      break;
+    }
   }
 }
 /** Duplicate a task */
@@ -332,6 +368,14 @@ void NewCopyStart(u32 method, const Task *orig_task, FullPtr<Task> &dup_task, bo
       chi::CALL_NEW_COPY_START(reinterpret_cast<const UpdateDomainTask*>(orig_task), dup_task, deep);
       break;
     }
+    case Method::kRegisterBuffer: {
+      chi::CALL_NEW_COPY_START(reinterpret_cast<const RegisterBufferTask*>(orig_task), dup_task, deep);
+      break;
+    }
+    case Method::kResizeQueue: {
+      chi::CALL_NEW_COPY_START(reinterpret_cast<const ResizeQueueTask*>(orig_task), dup_task, deep);
+      break;
+    }
   }
 }
 /** Serialize a task when initially pushing into remote */
@@ -395,6 +439,14 @@ void SaveStart(
       ar << *reinterpret_cast<UpdateDomainTask*>(task);
       break;
     }
+    case Method::kRegisterBuffer: {
+      ar << *reinterpret_cast<RegisterBufferTask*>(task);
+      break;
+    }
+    case Method::kResizeQueue: {
+      ar << *reinterpret_cast<ResizeQueueTask*>(task);
+      break;
+    }
   }
 }
 /** Deserialize a task when popping from remote queue */
@@ -485,6 +537,18 @@ TaskPointer LoadStart(    u32 method, BinaryInputArchive<true> &ar) override {
       ar >> *reinterpret_cast<UpdateDomainTask*>(task_ptr.ptr_);
       break;
     }
+    case Method::kRegisterBuffer: {
+      task_ptr.ptr_ = CHI_CLIENT->NewEmptyTask<RegisterBufferTask>(
+             HSHM_DEFAULT_MEM_CTX, task_ptr.shm_);
+      ar >> *reinterpret_cast<RegisterBufferTask*>(task_ptr.ptr_);
+      break;
+    }
+    case Method::kResizeQueue: {
+      task_ptr.ptr_ = CHI_CLIENT->NewEmptyTask<ResizeQueueTask>(
+             HSHM_DEFAULT_MEM_CTX, task_ptr.shm_);
+      ar >> *reinterpret_cast<ResizeQueueTask*>(task_ptr.ptr_);
+      break;
+    }
   }
   return task_ptr;
 }
@@ -547,6 +611,14 @@ void SaveEnd(u32 method, BinaryOutputArchive<false> &ar, Task *task) override {
       ar << *reinterpret_cast<UpdateDomainTask*>(task);
       break;
     }
+    case Method::kRegisterBuffer: {
+      ar << *reinterpret_cast<RegisterBufferTask*>(task);
+      break;
+    }
+    case Method::kResizeQueue: {
+      ar << *reinterpret_cast<ResizeQueueTask*>(task);
+      break;
+    }
   }
 }
 /** Deserialize a task when popping from remote queue */
@@ -608,7 +680,66 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
       ar >> *reinterpret_cast<UpdateDomainTask*>(task);
       break;
     }
+    case Method::kRegisterBuffer: {
+      ar >> *reinterpret_cast<RegisterBufferTask*>(task);
+      break;
+    }
+    case Method::kResizeQueue: {
+      ar >> *reinterpret_cast<ResizeQueueTask*>(task);
+      break;
+    }
   }
 }
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kCreateContainer, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->CreateContainer(reinterpret_cast<CreateContainerTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroyContainer, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->DestroyContainer(reinterpret_cast<DestroyContainerTask *>(task), rctx);
+  });
+  SetRunFun(Method::kRegisterModule, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->RegisterModule(reinterpret_cast<RegisterModuleTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroyModule, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->DestroyModule(reinterpret_cast<DestroyModuleTask *>(task), rctx);
+  });
+  SetRunFun(Method::kUpgradeModule, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->UpgradeModule(reinterpret_cast<UpgradeModuleTask *>(task), rctx);
+  });
+  SetRunFun(Method::kGetPoolId, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->GetPoolId(reinterpret_cast<GetPoolIdTask *>(task), rctx);
+  });
+  SetRunFun(Method::kStopRuntime, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->StopRuntime(reinterpret_cast<StopRuntimeTask *>(task), rctx);
+  });
+  SetRunFun(Method::kSetWorkOrchQueuePolicy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->SetWorkOrchQueuePolicy(reinterpret_cast<SetWorkOrchQueuePolicyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kSetWorkOrchProcPolicy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->SetWorkOrchProcPolicy(reinterpret_cast<SetWorkOrchProcPolicyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kFlush, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Flush(reinterpret_cast<FlushTask *>(task), rctx);
+  });
+  SetRunFun(Method::kGetDomainSize, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->GetDomainSize(reinterpret_cast<GetDomainSizeTask *>(task), rctx);
+  });
+  SetRunFun(Method::kUpdateDomain, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->UpdateDomain(reinterpret_cast<UpdateDomainTask *>(task), rctx);
+  });
+  SetRunFun(Method::kRegisterBuffer, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->RegisterBuffer(reinterpret_cast<RegisterBufferTask *>(task), rctx);
+  });
+  SetRunFun(Method::kResizeQueue, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->ResizeQueue(reinterpret_cast<ResizeQueueTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_CHIMAERA_ADMIN_LIB_EXEC_H_
\ No newline at end of file
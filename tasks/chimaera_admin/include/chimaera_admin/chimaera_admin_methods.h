@@ -15,7 +15,9 @@ struct Method : public TaskMethod {
   TASK_METHOD_T kFlush = 19;
   TASK_METHOD_T kGetDomainSize = 20;
   TASK_METHOD_T kUpdateDomain = 21;
-  TASK_METHOD_T kCount = 22;
+  TASK_METHOD_T kRegisterBuffer = 22;
+  TASK_METHOD_T kResizeQueue = 23;
+  TASK_METHOD_T kCount = 24;
 };
 
 #endif  // CHI_CHIMAERA_ADMIN_METHODS_H_
\ No newline at end of file
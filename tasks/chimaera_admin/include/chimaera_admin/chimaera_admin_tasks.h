@@ -561,6 +561,103 @@ struct UpdateDomainTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN void SerializeEnd(Ar &ar) {}
 };
 
+/** A task to map a client's buffer into the runtime */
+struct RegisterBufferTask : public Task, TaskFlags<TF_SRL_SYM> {
+  IN chi::ipc::string name_;
+
+  /** SHM default constructor */
+  HSHM_INLINE_CROSS_FUN
+  explicit RegisterBufferTask(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc)
+      : Task(alloc), name_(alloc) {}
+
+  /** Emplace constructor */
+  HSHM_INLINE_CROSS_FUN
+  explicit RegisterBufferTask(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc,
+                              const TaskNode &task_node, const PoolId &pool_id,
+                              const DomainQuery &dom_query,
+                              const chi::string &name)
+      : Task(alloc), name_(alloc, name) {
+    // Initialize task
+    task_node_ = task_node;
+    prio_ = TaskPrioOpt::kLowLatency;
+    pool_ = CHI_QM->admin_pool_id_;
+    method_ = Method::kRegisterBuffer;
+    task_flags_.SetBits(0);
+    dom_query_ = dom_query;
+  }
+
+  /** Duplicate message */
+  HSHM_INLINE_CROSS_FUN
+  void CopyStart(const RegisterBufferTask &other, bool deep) {
+    name_ = other.name_;
+  }
+
+  /** (De)serialize message call */
+  template <typename Ar>
+  HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
+    ar(name_);
+  }
+
+  /** (De)serialize message return */
+  template <typename Ar>
+  HSHM_INLINE_CROSS_FUN void SerializeEnd(Ar &ar) {}
+};
+
+/** A task to change the lanes and depth of one priority of a queue */
+struct ResizeQueueTask : public Task, TaskFlags<TF_SRL_SYM> {
+  IN QueueId queue_id_;
+  IN u32 queue_prio_;
+  IN u32 num_lanes_;
+  IN u32 depth_;
+
+  /** SHM default constructor */
+  HSHM_INLINE_CROSS_FUN
+  explicit ResizeQueueTask(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc)
+      : Task(alloc) {}
+
+  /** Emplace constructor */
+  HSHM_INLINE_CROSS_FUN
+  explicit ResizeQueueTask(const hipc::CtxAllocator<CHI_ALLOC_T> &alloc,
+                           const TaskNode &task_node, const PoolId &pool_id,
+                           const DomainQuery &dom_query,
+                           const QueueId &queue_id, u32 queue_prio,
+                           u32 num_lanes, u32 depth)
+      : Task(alloc) {
+    // Initialize task
+    task_node_ = task_node;
+    prio_ = TaskPrioOpt::kLowLatency;
+    pool_ = CHI_QM->admin_pool_id_;
+    method_ = Method::kResizeQueue;
+    task_flags_.SetBits(0);
+    dom_query_ = dom_query;
+
+    // Initialize resize
+    queue_id_ = queue_id;
+    queue_prio_ = queue_prio;
+    num_lanes_ = num_lanes;
+    depth_ = depth;
+  }
+
+  /** Duplicate message */
+  HSHM_INLINE_CROSS_FUN
+  void CopyStart(const ResizeQueueTask &other, bool deep) {
+    queue_id_ = other.queue_id_;
+    queue_prio_ = other.queue_prio_;
+    num_lanes_ = other.num_lanes_;
+    depth_ = other.depth_;
+  }
+
+  /** (De)serialize message call */
+  template <typename Ar>
+  HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
+    ar(queue_id_, queue_prio_, num_lanes_, depth_);
+  }
+
+  /** (De)serialize message return */
+  template <typename Ar>
+  HSHM_INLINE_CROSS_FUN void SerializeEnd(Ar &ar) {}
+};
+
 }  // namespace chi::Admin
 
 #endif  // CHI_TASKS_CHI_ADMIN_INCLUDE_CHI_ADMIN_CHI_ADMIN_TASKS_H_
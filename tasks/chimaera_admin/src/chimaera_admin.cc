@@ -75,10 +75,17 @@ class Server : public Module {
     return GetLaneByHash(kDefaultGroup, task->prio_, 0);
   }
 
+  /** Bump the pool generation of every node */
+  void InvalidatePoolCaches() {
+    CHI_ADMIN->UpdateDomain(HSHM_DEFAULT_MEM_CTX,
+                            DomainQuery::GetGlobalBcast(), {});
+  }
+
   /** Update number of lanes */
   void UpdateDomain(UpdateDomainTask *task, RunContext &rctx) {
     std::vector<UpdateDomainInfo> ops = task->ops_.vec();
     CHI_RPC->UpdateDomains(ops);
+    CHI_CLIENT->header_->pool_gen_.fetch_add(1);
   }
   void MonitorUpdateDomain(MonitorModeId mode, UpdateDomainTask *task,
                            RunContext &rctx) {
@@ -106,7 +113,11 @@ class Server : public Module {
     MonitorBase(mode, Method::kDestroyModule, task, rctx);
   }
 
-  /** Upgrade a module dynamically */
+  /**
+   * Upgrade a module dynamically. Only the module's containers are
+   * quiesced: their new tasks are parked while in-flight tasks drain,
+   * then the containers are swapped and the parked tasks replayed.
+   * */
   void UpgradeModule(UpgradeModuleTask *task, RunContext &rctx) {
     ScopedCoRwWriteLock upgrade_lock(CHI_MOD_REGISTRY->upgrade_lock_);
     // Get the set of ChiContainers
@@ -114,42 +125,39 @@ class Server : public Module {
     std::vector<Container *> containers =
         CHI_MOD_REGISTRY->GetContainers(lib_name);
     std::vector<Container *> new_containers;
+    // This task is in flight on its own container, which would never drain
+    for (Container *container : containers) {
+      if (container->quiesce_.get() == rctx.quiesce_) {
+        HELOG(kError, "Cannot upgrade {} from one of its own containers",
+              lib_name);
+        return;
+      }
+    }
     // Load the updated code
     ModuleInfo new_info;
     CHI_MOD_REGISTRY->LoadModule(lib_name, new_info);
-    // Copy the old state to the new
+    // Park new tasks and wait for in-flight tasks to complete
     for (Container *container : containers) {
-      Container *new_container = new_info.alloc_state_();
-      (*new_container) = (*container);
-      task->old_ = container;
-      new_container->Run(Method::kUpgrade, task, rctx);
-      new_containers.emplace_back(new_container);
+      container->quiesce_->Begin();
     }
-    // Get current iter count for each worker
-    std::vector<size_t> iter_counts;
-    for (std::unique_ptr<Worker> &worker : CHI_WORK_ORCHESTRATOR->workers_) {
-      iter_counts.push_back(worker->iter_count_);
-    }
-    // Plug all module-related lanes
     for (Container *container : containers) {
-      container->PlugAllLanes();
-    }
-    // Wait for at least two iterations per-worker
-    for (size_t i = 0; i < iter_counts.size(); ++i) {
-      while (CHI_WORK_ORCHESTRATOR->workers_[i]->iter_count_ <
-             iter_counts[i] + 2) {
+      while (!container->quiesce_->IsDrained()) {
         task->Yield();
       }
     }
     HILOG(kInfo, "Upgrading on worker {}",
           CHI_WORK_ORCHESTRATOR->GetCurrentWorker()->id_);
-    // Wait for all active tasks to complete
+    // Copy the old state to the new
     for (Container *container : containers) {
-      while (container->GetNumActiveTasks() > 0) {
-        //        HILOG(kInfo, "Active tasks: {}",
-        //        container->GetNumActiveTasks());
-        task->Yield();
-      }
+      Container *new_container = new_info.alloc_state_();
+      // The old run table points into the old library, so keep the one
+      // the new library built and only copy the container's state
+      std::vector<RunFun> run_table = std::move(new_container->run_table_);
+      (*new_container) = (*container);
+      new_container->run_table_ = std::move(run_table);
+      task->old_ = container;
+      new_container->Run(Method::kUpgrade, task, rctx);
+      new_containers.emplace_back(new_container);
     }
     // Plug the module & replace pointers
     CHI_MOD_REGISTRY->PlugModule(lib_name);
@@ -157,11 +165,14 @@ class Server : public Module {
     for (Container *new_container : new_containers) {
       CHI_MOD_REGISTRY->ReplaceContainer(new_container);
     }
-    // Unplug everything
-    for (Container *container : containers) {
-      container->UnplugAllLanes();
-    }
     CHI_MOD_REGISTRY->UnplugModule(lib_name);
+    // Replay the parked tasks on the new containers
+    Worker *worker = CHI_WORK_ORCHESTRATOR->GetCurrentWorker();
+    for (Container *new_container : new_containers) {
+      for (FullPtr<Task> &parked : new_container->quiesce_->End()) {
+        worker->active_.push(parked);
+      }
+    }
   }
   void MonitorUpgradeModule(MonitorModeId mode, UpgradeModuleTask *task,
                             RunContext &rctx) {
@@ -221,12 +232,15 @@ class Server : public Module {
       HELOG(kFatal, "Failed to create container: {}", pool_name);
       return;
     }
+    CHI_CLIENT->header_->pool_gen_.fetch_add(1);
     if (task->root_) {
       // Broadcast the state creation to all nodes
       CHI_ADMIN->CreateContainer(HSHM_DEFAULT_MEM_CTX, task->affinity_, *task);
       HILOG(kInfo,
             "(node {}) Broadcasting container creation (task_node={}): pool {}",
             CHI_RPC->node_id_, task->task_node_, task->pool_name_.str());
+      // Nodes outside the affinity may have cached the pool's absence
+      InvalidatePoolCaches();
     }
     HILOG(kInfo, "(node {}) Created containers for task {}", CHI_RPC->node_id_,
           task->task_node_);
@@ -288,6 +302,9 @@ class Server : public Module {
   /** Destroy a pool */
   void DestroyContainer(DestroyContainerTask *task, RunContext &rctx) {
     CHI_MOD_REGISTRY->DestroyContainer(task->id_);
+    CHI_CLIENT->header_->pool_gen_.fetch_add(1);
+    // Clients on other nodes may still cache the destroyed pool
+    InvalidatePoolCaches();
   }
   void MonitorDestroyContainer(MonitorModeId mode, DestroyContainerTask *task,
                                RunContext &rctx) {
@@ -367,6 +384,25 @@ class Server : public Module {
     MonitorBase(mode, Method::kGetDomainSize, task, rctx);
   }
 
+  /** Map a client's registered buffer into the runtime */
+  void RegisterBuffer(RegisterBufferTask *task, RunContext &rctx) {
+    CHI_CLIENT->AttachBuffer(task->name_.str());
+  }
+  void MonitorRegisterBuffer(MonitorModeId mode, RegisterBufferTask *task,
+                             RunContext &rctx) {
+    MonitorBase(mode, Method::kRegisterBuffer, task, rctx);
+  }
+
+  /** Resize one priority of a local queue */
+  void ResizeQueue(ResizeQueueTask *task, RunContext &rctx) {
+    CHI_QM->ResizeQueue(task->queue_id_, task->queue_prio_, task->num_lanes_,
+                        task->depth_, task);
+  }
+  void MonitorResizeQueue(MonitorModeId mode, ResizeQueueTask *task,
+                          RunContext &rctx) {
+    MonitorBase(mode, Method::kResizeQueue, task, rctx);
+  }
+
  public:
 #include "chimaera_admin/chimaera_admin_lib_exec.h"
 };
@@ -290,5 +290,26 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
     }
   }
 }
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kClientPushSubmit, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->ClientPushSubmit(reinterpret_cast<ClientPushSubmitTask *>(task), rctx);
+  });
+  SetRunFun(Method::kClientSubmit, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->ClientSubmit(reinterpret_cast<ClientSubmitTask *>(task), rctx);
+  });
+  SetRunFun(Method::kServerPushComplete, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->ServerPushComplete(reinterpret_cast<ServerPushCompleteTask *>(task), rctx);
+  });
+  SetRunFun(Method::kServerComplete, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->ServerComplete(reinterpret_cast<ServerCompleteTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_REMOTE_QUEUE_LIB_EXEC_H_
\ No newline at end of file
@@ -90,13 +90,13 @@ class Server : public Module {
   void Direct(Task *submit_task, Task *orig_task,
               ResolvedDomainQuery &res_query, RunContext &rctx) {
     // Save the original domain query
-    Task *orig_pending_to = orig_task->rctx_.pending_to_;
+    Task *orig_pending_to = orig_task->GetRunContext().pending_to_;
     DomainQuery orig_dom_query = orig_task->dom_query_;
     orig_task->dom_query_ = res_query.dom_;
 
     // Register the block
     submit_task->SetBlocked(1);
-    orig_task->rctx_.pending_to_ = submit_task;
+    orig_task->GetRunContext().pending_to_ = submit_task;
 
     // Submit to the new domain
     size_t node_hash = hshm::hash<NodeId>{}(res_query.node_);
@@ -109,7 +109,7 @@ class Server : public Module {
 
     // Restore the original domain query
     orig_task->dom_query_ = orig_dom_query;
-    orig_task->rctx_.pending_to_ = orig_pending_to;
+    orig_task->GetRunContext().pending_to_ = orig_pending_to;
   }
 
   /** Replicate the task across a node set */
@@ -134,7 +134,7 @@ class Server : public Module {
         exec->Monitor(MonitorMode::kReplicaStart, orig_task->method_, orig_task,
                       rctx);
       }
-      rep_task->rctx_.pending_to_ = submit_task;
+      rep_task->GetRunContext().pending_to_ = submit_task;
       size_t node_hash = hshm::hash<NodeId>{}(res_query.node_);
       auto &submit = submit_;
       HLOG(kDebug, kRemoteQueue, "[TASK_CHECK] Task replica addr {}",
@@ -245,7 +245,7 @@ class Server : public Module {
   /** Complete the task (on the remote node) */
   void ServerPushComplete(ServerPushCompleteTask *task, RunContext &rctx) {
     HLOG(kDebug, kRemoteQueue, "");
-    NodeId ret_node = task->rctx_.ret_node_;
+    NodeId ret_node = task->GetRunContext().ret_node_;
     size_t node_hash = hshm::hash<NodeId>{}(ret_node);
     auto &complete = complete_;
     complete[node_hash % complete.size()].emplace(
@@ -334,16 +334,16 @@ class Server : public Module {
     }
     TaskPointer rep_task = exec->LoadStart(method, ar);
     rep_task->dom_query_ = xfer.tasks_[task_off].dom_;
-    rep_task->rctx_.ret_task_addr_ = xfer.tasks_[task_off].task_addr_;
-    rep_task->rctx_.ret_node_ = xfer.ret_node_;
-    if (rep_task->rctx_.ret_task_addr_ == (size_t)rep_task.ptr_) {
+    rep_task->GetRunContext().ret_task_addr_ = xfer.tasks_[task_off].task_addr_;
+    rep_task->GetRunContext().ret_node_ = xfer.ret_node_;
+    if (rep_task->GetRunContext().ret_task_addr_ == (size_t)rep_task.ptr_) {
       HELOG(kFatal, "This shouldn't happen ever");
     }
     HLOG(kDebug, kRemoteQueue,
          "[TASK_CHECK] (node {}) Deserialized task {} with replica addr {} "
          "(pool={}, method={})",
          CHI_CLIENT->node_id_, rep_task.ptr_,
-         (void *)rep_task->rctx_.ret_task_addr_, pool_id, method);
+         (void *)rep_task->GetRunContext().ret_task_addr_, pool_id, method);
 
     // Unset task flags
     // NOTE(llogan): Remote tasks are executed to completion and
@@ -382,13 +382,13 @@ class Server : public Module {
       // Unblock completed tasks
       for (size_t i = 0; i < xfer.tasks_.size(); ++i) {
         Task *rep_task = (Task *)xfer.tasks_[i].task_addr_;
-        Task *submit_task = rep_task->rctx_.pending_to_;
+        Task *submit_task = rep_task->GetRunContext().pending_to_;
         HLOG(kDebug, kRemoteQueue, "[TASK_CHECK] Unblocking the submit_task {}",
              submit_task);
         if (submit_task->pool_ != id_) {
           HELOG(kFatal, "This shouldn't happen ever");
         }
-        CHI_WORK_ORCHESTRATOR->SignalUnblock(submit_task, submit_task->rctx_);
+        CHI_WORK_ORCHESTRATOR->SignalUnblock(submit_task, submit_task->GetRunContext());
       }
     } catch (hshm::Error &e) {
       HELOG(kError, "(node {}) Worker {} caught an error: {}",
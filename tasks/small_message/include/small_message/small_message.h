@@ -58,7 +58,7 @@ class Client : public ModuleClient {
     FullPtr<IoTask> task = AsyncIo(mctx, dom_query, io_size, io_flags);
     task->Wait();
     write_ret = task->ret_;
-    char *data = CHI_CLIENT->GetDataPointer(task->data_);
+    char *data = task->data_.data();
     read_ret = 0;
     for (size_t i = 0; i < io_size; ++i) {
       read_ret += data[i];
@@ -250,5 +250,45 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
     }
   }
 }
+/** Merge a queued task into the run headed by a task */
+bool Merge(u32 method, Task *task, const Task *next) override {
+  switch (method) {
+    case Method::kMd: {
+      return chi::CALL_MERGE(
+        reinterpret_cast<MdTask*>(task), 
+        reinterpret_cast<const MdTask*>(next));
+    }
+  }
+  return false;
+}
+/** Copy the results of a task to a task merged into it */
+void MergeEnd(u32 method, const Task *task, Task *merged) override {
+  switch (method) {
+    case Method::kMd: {
+      chi::CALL_MERGE_END(
+        reinterpret_cast<const MdTask*>(task), 
+        reinterpret_cast<MdTask*>(merged));
+      break;
+    }
+  }
+}
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kUpgrade, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Upgrade(reinterpret_cast<UpgradeTask *>(task), rctx);
+  });
+  SetRunFun(Method::kMd, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Md(reinterpret_cast<MdTask *>(task), rctx);
+  });
+  SetRunFun(Method::kIo, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Io(reinterpret_cast<IoTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_SMALL_MESSAGE_LIB_EXEC_H_
\ No newline at end of file
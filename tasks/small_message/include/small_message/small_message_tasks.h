@@ -40,7 +40,8 @@ typedef chi::Admin::UpgradeModuleTask UpgradeTask;
 /**
  * A custom task in small_message
  * */
-struct MdTask : public Task, TaskFlags<TF_SRL_SYM> {
+struct MdTask : public Task,
+                TaskFlags<TF_SRL_SYM | TF_SRL_POD | TF_MERGE | TF_CMPGRP> {
   IN u32 depth_;
   OUT int ret_;
 
@@ -71,6 +72,16 @@ struct MdTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN
   void CopyStart(const MdTask &other, bool deep) { depth_ = other.depth_; }
 
+  /** Identical lookups share one result */
+  HSHM_INLINE_CROSS_FUN
+  bool Merge(const MdTask &next) {
+    return next.depth_ == depth_ && next.dom_query_ == dom_query_;
+  }
+
+  /** Copy the shared result */
+  HSHM_INLINE_CROSS_FUN
+  void MergeEnd(const MdTask &task) { ret_ = task.ret_; }
+
   /** (De)serialize message call */
   template <typename Ar>
   HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
@@ -90,8 +101,7 @@ struct MdTask : public Task, TaskFlags<TF_SRL_SYM> {
 #define MD_IO_WRITE BIT_OPT(chi::IntFlag, 0)
 #define MD_IO_READ BIT_OPT(chi::IntFlag, 1)
 struct IoTask : public Task, TaskFlags<TF_SRL_SYM> {
-  IN hipc::Pointer data_;
-  IN size_t size_;
+  IN TaskData<> data_; /**< The I/O payload and its size */
   IN ibitfield io_flags_;
   OUT size_t ret_;
 
@@ -114,20 +124,17 @@ struct IoTask : public Task, TaskFlags<TF_SRL_SYM> {
     dom_query_ = dom_query;
 
     // Custom params
-    FullPtr<char> data =
-        CHI_CLIENT->AllocateBuffer(HSHM_DEFAULT_MEM_CTX, io_size);
-    data_ = data.shm_;
-    size_ = io_size;
+    CHI_CLIENT->AllocateTaskData(HSHM_DEFAULT_MEM_CTX, data_, io_size);
     ret_ = 0;
     io_flags_.SetBits(io_flags);
-    memset(data.ptr_, 10, io_size);
+    memset(data_.data(), 10, io_size);
   }
 
   /** Destructor */
   HSHM_INLINE_CROSS_FUN
   ~IoTask() {
     if (IsDataOwner()) {
-      CHI_CLIENT->FreeBuffer(data_);
+      CHI_CLIENT->FreeTaskData(data_);
     }
   }
 
@@ -135,7 +142,6 @@ struct IoTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN
   void CopyStart(const IoTask &other, bool deep) {
     data_ = other.data_;
-    size_ = other.size_;
     io_flags_ = other.io_flags_;
   }
 
@@ -144,9 +150,9 @@ struct IoTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN void SerializeStart(Ar &ar) {
     ar(io_flags_);
     if (io_flags_.Any(MD_IO_WRITE)) {
-      ar.bulk(DT_WRITE, data_, size_);
+      ar.bulk(DT_WRITE, data_);
     } else {
-      ar.bulk(DT_EXPOSE, data_, size_);
+      ar.bulk(DT_EXPOSE, data_);
     }
   }
 
@@ -155,7 +161,7 @@ struct IoTask : public Task, TaskFlags<TF_SRL_SYM> {
   HSHM_INLINE_CROSS_FUN void SerializeEnd(Ar &ar) {
     ar(io_flags_, ret_);
     if (io_flags_.Any(MD_IO_READ)) {
-      ar.bulk(DT_WRITE, data_, size_);
+      ar.bulk(DT_WRITE, data_);
     }
   }
 };
@@ -141,21 +141,22 @@ class Server : public Module {
 
   /** An I/O task */
   void Io(IoTask *task, RunContext &rctx) {
-    char *data = CHI_CLIENT->GetDataPointer(task->data_);
+    char *data = task->data_.data();
+    size_t size = task->data_.size();
     task->ret_ = 0;
-    for (size_t i = 0; i < task->size_; ++i) {
+    for (size_t i = 0; i < size; ++i) {
       task->ret_ += data[i];
     }
-    memset(data, 15, task->size_);
+    memset(data, 15, size);
   }
   void MonitorIo(MonitorModeId mode, IoTask *task, RunContext &rctx) {
     switch (mode) {
       case MonitorMode::kEstLoad: {
-        rctx.load_.cpu_load_ = monitor_io_.consts_[0] * task->size_;
+        rctx.load_.cpu_load_ = monitor_io_.consts_[0] * task->data_.size();
         break;
       }
       case MonitorMode::kSampleLoad: {
-        monitor_io_.Add({(float)task->size_,
+        monitor_io_.Add({(float)task->data_.size(),
                          // (float)rctx.load_.cpu_load_,
                          (float)rctx.timer_.GetNsec()},
                         rctx.load_);
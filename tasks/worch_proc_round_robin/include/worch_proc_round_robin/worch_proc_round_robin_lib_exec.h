@@ -170,5 +170,17 @@ void LoadEnd(u32 method, BinaryInputArchive<false> &ar, Task *task) override {
     }
   }
 }
+/** Build the direct-dispatch table for Run */
+void InitRunTable() override {
+  SetRunFun(Method::kCreate, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Create(reinterpret_cast<CreateTask *>(task), rctx);
+  });
+  SetRunFun(Method::kDestroy, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Destroy(reinterpret_cast<DestroyTask *>(task), rctx);
+  });
+  SetRunFun(Method::kSchedule, [](Module *exec, Task *task, RunContext &rctx) {
+    static_cast<Server *>(exec)->Schedule(reinterpret_cast<ScheduleTask *>(task), rctx);
+  });
+}
 
 #endif  // CHI_WORCH_PROC_ROUND_ROBIN_LIB_EXEC_H_
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "basic_test.h"
 #include "bdev/bdev.h"
 #include "chimaera/api/chimaera_client.h"
+#include "chimaera/api/chimaera_coroutine.h"
 #include "chimaera_admin/chimaera_admin.h"
 #include "omp.h"
 #include "small_message/small_message.h"
@@ -108,6 +109,55 @@ TEST_CASE("TestAsyncIpc") {
         ops * (depth + 1) / t.GetUsec());
 }
 
+#ifdef CHIMAERA_ENABLE_COROUTINES
+chi::CoTask<int> CoMd(chi::small_message::Client &client, int cont_id) {
+  FullPtr<chi::small_message::MdTask> task = co_await client.AsyncMd(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers,
+                                      cont_id),
+      0, 0);
+  int ret = task->ret_;
+  CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  co_return ret;
+}
+
+chi::CoTask<size_t> CoMdBatch(chi::small_message::Client &client,
+                              size_t ops) {
+  std::vector<chi::CoTask<int>> reqs;
+  reqs.reserve(ops);
+  for (size_t i = 0; i < ops; ++i) {
+    reqs.emplace_back(CoMd(client, i));
+  }
+  size_t sum = 0;
+  for (chi::CoTask<int> &req : reqs) {
+    sum += co_await req;
+  }
+  co_return sum;
+}
+
+TEST_CASE("TestCoroutineIpc") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+
+  size_t ops = 256;
+  hshm::Timer t;
+  t.Resume();
+  size_t sum = chi::CoRun(CoMdBatch(client, ops));
+  t.Pause();
+  REQUIRE(sum == ops);
+  REQUIRE(chi::CoEventLoop::Get().IsEmpty());
+  HILOG(kInfo, "Latency: {} MOps", ops / t.GetUsec());
+}
+#endif
+
 TEST_CASE("TestFlush") {
   CHIMAERA_CLIENT_INIT();
 
@@ -147,6 +197,190 @@ TEST_CASE("TestFlush") {
   HILOG(kInfo, "Latency: {} MOps", ops / t.GetUsec());
 }
 
+TEST_CASE("TestTaskDag") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+
+  // A diamond: 0 -> {1, 2} -> 3
+  size_t ntasks = 4;
+  std::vector<FullPtr<chi::Task>> tasks;
+  for (size_t i = 0; i < ntasks; ++i) {
+    FullPtr<chi::small_message::MdTask> task = client.AsyncMdAlloc(
+        HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(),
+        chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers,
+                                        i),
+        0, 0);
+    tasks.emplace_back(task.template Cast<chi::Task>());
+  }
+  CHI_CLIENT->AddDependency(HSHM_DEFAULT_MEM_CTX, tasks[0], tasks[1]);
+  CHI_CLIENT->AddDependency(HSHM_DEFAULT_MEM_CTX, tasks[0], tasks[2]);
+  CHI_CLIENT->AddDependency(HSHM_DEFAULT_MEM_CTX, tasks[1], tasks[3], true);
+  CHI_CLIENT->AddDependency(HSHM_DEFAULT_MEM_CTX, tasks[2], tasks[3]);
+  REQUIRE(tasks[3]->GetLinks()->dag_deps_.load() == 2);
+  CHI_CLIENT->ScheduleDag(nullptr, tasks.data(), tasks.size());
+
+  for (FullPtr<chi::Task> &task : tasks) {
+    task->Wait();
+    REQUIRE(!task->HasDagEdges());
+  }
+  REQUIRE(tasks[3]->GetDagInput().ptr_ == tasks[1].ptr_);
+  for (FullPtr<chi::Task> &task : tasks) {
+    FullPtr<chi::small_message::MdTask> md_task =
+        task.template Cast<chi::small_message::MdTask>();
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, md_task);
+  }
+}
+
+TEST_CASE("TestTaskGroup") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+
+  size_t ntasks = 8;
+  std::vector<FullPtr<chi::small_message::MdTask>> tasks;
+  for (size_t i = 0; i < ntasks; ++i) {
+    tasks.emplace_back(client.AsyncMdAlloc(
+        HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(),
+        chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers,
+                                        0),
+        0, 0));
+  }
+  CHI_CLIENT->ScheduleGroup(nullptr, tasks.data(), tasks.size());
+
+  // Only the leader is notified, after the whole group ended
+  tasks[0]->Wait();
+  for (FullPtr<chi::small_message::MdTask> &task : tasks) {
+    REQUIRE(task->IsComplete());
+    REQUIRE(!task->IsGrouped());
+  }
+  for (FullPtr<chi::small_message::MdTask> &task : tasks) {
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+}
+
+TEST_CASE("TestTaskBatch") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+
+  // The batch overflows its first lane and must spill, not drop tasks
+  chi::ingress::MultiQueue *queue =
+      CHI_QM->GetQueue(CHI_QM->process_queue_id_);
+  size_t ntasks =
+      2 * queue->GetGroup(chi::TaskPrioOpt::kLowLatency).depth_ + 1;
+  std::vector<FullPtr<chi::small_message::MdTask>> tasks;
+  tasks.reserve(ntasks);
+  for (size_t i = 0; i < ntasks; ++i) {
+    tasks.emplace_back(client.AsyncMdAlloc(
+        HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(),
+        chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers,
+                                        0),
+        0, 0));
+  }
+  client.AsyncMdBatch(tasks.data(), tasks.size());
+  for (FullPtr<chi::small_message::MdTask> &task : tasks) {
+    task->Wait();
+    REQUIRE(task->ret_ == 1);
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+}
+
+TEST_CASE("TestCompletionQueue") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+
+  // Reap every task through the queue instead of waiting on it
+  size_t ntasks = 256;
+  FullPtr<chi::ingress::CompletionQueue> cq =
+      CHI_CLIENT->NewCompletionQueue(HSHM_DEFAULT_MEM_CTX, ntasks);
+  for (size_t i = 0; i < ntasks; ++i) {
+    FullPtr<chi::small_message::MdTask> task = client.AsyncMdAlloc(
+        HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(),
+        chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers,
+                                        i),
+        0, 0);
+    task->SetCompletionQueue(cq.shm_);
+    CHI_CLIENT->ScheduleTask(nullptr, task);
+  }
+  std::vector<FullPtr<chi::Task>> done(16);
+  size_t reaped = 0;
+  while (reaped < ntasks) {
+    size_t count = CHI_CLIENT->ReapCompletions(cq, done.data(), done.size());
+    for (size_t i = 0; i < count; ++i) {
+      auto *task =
+          reinterpret_cast<chi::small_message::MdTask *>(done[i].ptr_);
+      REQUIRE(task->IsComplete());
+      REQUIRE(task->ret_ == 1);
+      CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+    }
+    reaped += count;
+  }
+  REQUIRE(CHI_CLIENT->ReapCompletions(cq, done.data(), done.size()) == 0);
+  CHI_CLIENT->DelCompletionQueue(HSHM_DEFAULT_MEM_CTX, cq);
+}
+
+TEST_CASE("TestPoolCache") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+  chi::DomainQuery local =
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kLocalContainers, 0);
+  chi::DomainQuery global =
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0);
+
+  // A lookup is cached for its own query only
+  chi::PoolId id;
+  REQUIRE(CHI_ADMIN->GetPoolId(HSHM_DEFAULT_MEM_CTX, local, "ipc_test") ==
+          client.id_);
+  REQUIRE(CHI_POOL_CACHE->GetPoolId("ipc_test", local, id));
+  REQUIRE(id == client.id_);
+  REQUIRE(!CHI_POOL_CACHE->GetPoolId("ipc_test", global, id));
+
+  // A domain update on any node drops the cached entries
+  u64 gen = chi::Admin::PoolCache::GetGeneration();
+  CHI_ADMIN->UpdateDomain(HSHM_DEFAULT_MEM_CTX,
+                          chi::DomainQuery::GetGlobalBcast(), {});
+  REQUIRE(chi::Admin::PoolCache::GetGeneration() != gen);
+  REQUIRE(!CHI_POOL_CACHE->GetPoolId("ipc_test", local, id));
+}
+
 void TestIpcMultithread(int nprocs) {
   CHIMAERA_CLIENT_INIT();
 
@@ -298,6 +532,54 @@ TEST_CASE("TestUpgrade") {
         ops * (depth + 1) / t.GetUsec());
 }
 
+TEST_CASE("TestResizeQueue") {
+  CHIMAERA_CLIENT_INIT();
+
+  int rank, nprocs;
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  chi::small_message::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(),
+                            "small_message");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "ipc_test");
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // Grow the process queue while tasks are in flight on both priorities
+  size_t ops = 4096;
+  chi::ingress::MultiQueue *queue =
+      CHI_QM->GetQueue(CHI_QM->process_queue_id_);
+  u32 max_lanes = queue->GetGroup(chi::TaskPrioOpt::kLowLatency).max_lanes_;
+  std::vector<FullPtr<chi::small_message::MdTask>> tasks;
+  tasks.reserve(ops);
+  for (size_t i = 0; i < ops; ++i) {
+    if (i == ops / 2) {
+      CHI_ADMIN->ResizeQueue(HSHM_DEFAULT_MEM_CTX, CHI_QM->process_queue_id_,
+                             chi::TaskPrioOpt::kLowLatency, max_lanes, 0);
+      CHI_ADMIN->ResizeQueue(HSHM_DEFAULT_MEM_CTX, CHI_QM->process_queue_id_,
+                             chi::TaskPrioOpt::kHighLatency, max_lanes / 2,
+                             0);
+    }
+    int cont_id = i;
+    tasks.emplace_back(
+        client.AsyncMd(HSHM_DEFAULT_MEM_CTX,
+                       chi::DomainQuery::GetDirectHash(
+                           chi::SubDomainId::kGlobalContainers, cont_id),
+                       0, 0));
+  }
+  for (FullPtr<chi::small_message::MdTask> &task : tasks) {
+    task->Wait();
+    REQUIRE(task->ret_ == 1);
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+  REQUIRE(queue->GetGroup(chi::TaskPrioOpt::kLowLatency).num_lanes_ ==
+          max_lanes);
+}
+
 void TestBdevIo(const std::string &path) {
   CHIMAERA_CLIENT_INIT();
 
@@ -369,6 +651,161 @@ TEST_CASE("TestBdevIo") { TestBdevIo("fs::///tmp/chi_test_bdev.bin"); }
 
 TEST_CASE("TestBdevRam") { TestBdevIo("ram:://"); }
 
+TEST_CASE("TestBdevUpgrade") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::bdev::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(), "bdev");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "upgrade_bdev", "ram:://",
+      GIGABYTES(1));
+  chi::DomainQuery dom_query =
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kLocalContainers, 0);
+  size_t size = KILOBYTES(4);
+  size_t ops = 256;
+  chi::Block block =
+      client.Allocate(HSHM_DEFAULT_MEM_CTX, dom_query, ops * size)[0];
+  hipc::FullPtr<char> io_write =
+      CHI_CLIENT->AllocateBuffer(HSHM_DEFAULT_MEM_CTX, ops * size);
+  hipc::FullPtr<char> io_read =
+      CHI_CLIENT->AllocateBuffer(HSHM_DEFAULT_MEM_CTX, ops * size);
+  for (size_t i = 0; i < ops; ++i) {
+    memset(io_write.ptr_ + i * size, (int)i, size);
+  }
+
+  // Writes submitted around the upgrade are parked and replayed
+  std::vector<FullPtr<chi::bdev::WriteTask>> writes;
+  FullPtr<chi::Admin::UpgradeModuleTask> upgrade;
+  for (size_t i = 0; i < ops; ++i) {
+    if (i == ops / 2) {
+      upgrade = CHI_ADMIN->AsyncUpgradeModule(
+          HSHM_DEFAULT_MEM_CTX, dom_query, "bdev");
+    }
+    hipc::Pointer data = HSHM_MEMORY_MANAGER->Convert<void, hipc::Pointer>(
+        io_write.ptr_ + i * size);
+    writes.emplace_back(client.AsyncWrite(HSHM_DEFAULT_MEM_CTX, dom_query,
+                                          data, block.off_ + i * size, size));
+  }
+  upgrade->Wait();
+  CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, upgrade);
+  for (FullPtr<chi::bdev::WriteTask> &task : writes) {
+    task->Wait();
+    REQUIRE(task->success_);
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+  client.Read(HSHM_DEFAULT_MEM_CTX, dom_query, io_read.shm_, block.off_,
+              ops * size);
+  REQUIRE(memcmp(io_write.ptr_, io_read.ptr_, ops * size) == 0);
+
+  // Upgrading the module that runs the upgrade is rejected, not hung
+  CHI_ADMIN->UpgradeModule(HSHM_DEFAULT_MEM_CTX, dom_query, "chimaera_admin");
+
+  CHI_CLIENT->FreeBuffer(io_write);
+  CHI_CLIENT->FreeBuffer(io_read);
+}
+
+TEST_CASE("TestMergeHooks") {
+  CHIMAERA_CLIENT_INIT();
+  chi::bdev::Client bdev;
+  chi::small_message::Client md;
+  chi::DomainQuery dom_query =
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kLocalContainers, 0);
+  size_t size = KILOBYTES(4);
+  auto new_write = [&](size_t off) {
+    return bdev.AsyncWriteAlloc(HSHM_DEFAULT_MEM_CTX,
+                                CHI_CLIENT->MakeTaskNodeId(), dom_query,
+                                hipc::Pointer::GetNull(), off, size,
+                                TASK_MERGE);
+  };
+
+  // Adjacent writes merge into the run of the head; gaps do not
+  FullPtr<chi::bdev::WriteTask> head = new_write(0);
+  FullPtr<chi::bdev::WriteTask> adjacent = new_write(size);
+  FullPtr<chi::bdev::WriteTask> after = new_write(2 * size);
+  FullPtr<chi::bdev::WriteTask> gap = new_write(4 * size);
+  REQUIRE(head->Merge(*adjacent));
+  REQUIRE(head->Merge(*after));
+  REQUIRE(!head->Merge(*gap));
+  head->success_ = true;
+  adjacent->success_ = false;
+  after->success_ = false;
+  chi::CALL_MERGE_END(head.ptr_, adjacent.ptr_);
+  chi::CALL_MERGE_END(head.ptr_, after.ptr_);
+  REQUIRE(adjacent->success_);
+  REQUIRE(after->success_);
+
+  // A run stops at the iovec limit of one pwritev
+  FullPtr<chi::bdev::WriteTask> run = new_write(0);
+  FullPtr<chi::bdev::WriteTask> next = new_write(size);
+  size_t count = 1;
+  while (run->Merge(*next)) {
+    next->off_ += size;
+    ++count;
+  }
+  REQUIRE(count == std::min<size_t>(BDEV_MAX_MERGE_IOV,
+                                    BDEV_MAX_MERGE_SIZE / size));
+
+  // Identical lookups share one result
+  FullPtr<chi::small_message::MdTask> md_head = md.AsyncMdAlloc(
+      HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(), dom_query, 0, 0);
+  FullPtr<chi::small_message::MdTask> md_same = md.AsyncMdAlloc(
+      HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(), dom_query, 0, 0);
+  FullPtr<chi::small_message::MdTask> md_other = md.AsyncMdAlloc(
+      HSHM_DEFAULT_MEM_CTX, CHI_CLIENT->MakeTaskNodeId(), dom_query, 1, 0);
+  REQUIRE(md_head->Merge(*md_same));
+  REQUIRE(!md_head->Merge(*md_other));
+  md_head->ret_ = 1;
+  chi::CALL_MERGE_END(md_head.ptr_, md_same.ptr_);
+  REQUIRE(md_same->ret_ == 1);
+  REQUIRE(md_other->ret_ == -1);
+
+  for (chi::bdev::WriteTask *task : {head.ptr_, adjacent.ptr_, after.ptr_,
+                                      gap.ptr_, run.ptr_, next.ptr_}) {
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+  for (chi::small_message::MdTask *task :
+       {md_head.ptr_, md_same.ptr_, md_other.ptr_}) {
+    CHI_CLIENT->DelTask(HSHM_DEFAULT_MEM_CTX, task);
+  }
+}
+
+TEST_CASE("TestBdevRegisteredBuffer") {
+  CHIMAERA_CLIENT_INIT();
+
+  chi::bdev::Client client;
+  CHI_ADMIN->RegisterModule(HSHM_DEFAULT_MEM_CTX,
+                            chi::DomainQuery::GetGlobalBcast(), "bdev");
+  client.Create(
+      HSHM_DEFAULT_MEM_CTX,
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0),
+      chi::DomainQuery::GetGlobalBcast(), "tempdir_regbuf", "ram:://",
+      GIGABYTES(1));
+
+  // Application data lives in the registered region: no staging copy
+  chi::RegisteredBuffer buf = CHI_ADMIN->RegisterBuffer(
+      HSHM_DEFAULT_MEM_CTX, "chi_test_regbuf", MEGABYTES(2));
+  REQUIRE(!buf.IsNull());
+  hipc::FullPtr<char> io_write = buf.Get(0);
+  hipc::FullPtr<char> io_read = buf.Get(MEGABYTES(1));
+
+  chi::DomainQuery dom_query =
+      chi::DomainQuery::GetDirectHash(chi::SubDomainId::kGlobalContainers, 0);
+  std::vector<chi::Block> blocks =
+      client.Allocate(HSHM_DEFAULT_MEM_CTX, dom_query, MEGABYTES(1));
+  chi::Block block = blocks[0];
+  memset(io_write.ptr_, 10, MEGABYTES(1));
+  client.Write(HSHM_DEFAULT_MEM_CTX, dom_query, io_write.shm_, block.off_,
+               MEGABYTES(1));
+  memset(io_read.ptr_, 0, MEGABYTES(1));
+  client.Read(HSHM_DEFAULT_MEM_CTX, dom_query, io_read.shm_, block.off_,
+              MEGABYTES(1));
+  REQUIRE(memcmp(io_write.ptr_, io_read.ptr_, MEGABYTES(1)) == 0);
+  client.Free(HSHM_DEFAULT_MEM_CTX, dom_query, block);
+}
+
 #ifdef CHIMAERA_ENABLE_PYTHON
 
 #include "chimaera/monitor/monitor.h"
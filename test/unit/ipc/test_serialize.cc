@@ -62,6 +62,56 @@ struct TestObj : public Task, TaskFlags<TF_SRL_SYM> {
   }
 };
 
+struct TestPodObj : public Task, TaskFlags<TF_SRL_SYM | TF_SRL_POD> {
+  int a_, b_;
+  size_t c_;
+
+  TestPodObj(int a, int b, size_t c) : a_(a), b_(b), c_(c), Task(0) {}
+
+  /** Duplicate message */
+  void CopyStart(const TestPodObj &other, bool deep) {}
+
+  /** (De)serialize message call */
+  template <typename Ar>
+  void SerializeStart(Ar &ar) {
+    ar(a_, b_, c_);
+  }
+
+  /** (De)serialize message return */
+  template <typename Ar>
+  void SerializeEnd(Ar &ar) {
+    ar(a_);
+  }
+};
+
+TEST_CASE("TestSerializePod") {
+  BinaryOutputArchive<true> out_start;
+  TestPodObj obj(25, 30, 35);
+  obj.method_ = 12;
+  out_start << obj;
+  SegmentedTransfer submit_xfer = out_start.Get();
+
+  BinaryInputArchive<true> in_start(submit_xfer);
+  TestPodObj obj2(0, 0, 0);
+  in_start >> obj2;
+  REQUIRE(obj2.a_ == 25);
+  REQUIRE(obj2.b_ == 30);
+  REQUIRE(obj2.c_ == 35);
+  REQUIRE(obj2.method_ == 12);
+
+  obj2.a_ = 256;
+  BinaryOutputArchive<false> out_end;
+  out_end << obj2;
+  SegmentedTransfer complete_xfer = out_end.Get();
+  // A task without a run context has no task to reply to
+  REQUIRE(complete_xfer.tasks_.size() == 1);
+  REQUIRE(complete_xfer.tasks_[0].task_addr_ == 0);
+
+  BinaryInputArchive<false> in_end(complete_xfer);
+  in_end >> obj;
+  REQUIRE(obj.a_ == 256);
+}
+
 TEST_CASE("TestSerialize") {
   std::vector<char> data(256);
 
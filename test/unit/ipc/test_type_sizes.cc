@@ -14,6 +14,8 @@
 #include <hermes_shm/util/timer.h>
 #include <mpi.h>
 
+#include <cstddef>
+
 #include "basic_test.h"
 #include "chimaera/api/chimaera_client.h"
 #include "chimaera_admin/chimaera_admin.h"
@@ -38,4 +40,56 @@ TEST_CASE("TestTypeSizes") {
   HILOG(kInfo, "Size of DomainQuery: {}", sizeof(chi::DomainQuery));
   HILOG(kInfo, "Size of RunContext: {}", sizeof(chi::RunContext));
   HILOG(kInfo, "Size of Task: {}", sizeof(chi::Task));
-}
\ No newline at end of file
+}
+
+/** Distance between two fields of a type */
+#define CHI_FIELD_DIST(T, A, B) \
+  (offsetof(T, A) > offsetof(T, B) ? offsetof(T, A) - offsetof(T, B) \
+                                   : offsetof(T, B) - offsetof(T, A))
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+// Ingress lanes: producer, consumer and ring on distinct lines
+static_assert(alignof(chi::ingress::Lane) >= CHI_CACHE_LINE_SIZE);
+static_assert(sizeof(chi::ingress::Lane) % CHI_CACHE_LINE_SIZE == 0);
+static_assert(CHI_FIELD_DIST(chi::ingress::Lane, emplace_count_, pop_count_) >=
+              CHI_CACHE_LINE_SIZE);
+static_assert(CHI_FIELD_DIST(chi::ingress::Lane, id_, queue_) >=
+              CHI_CACHE_LINE_SIZE);
+static_assert(CHI_FIELD_DIST(chi::ingress::Lane, queue_, emplace_count_) >=
+              CHI_CACHE_LINE_SIZE);
+// Ingress lanes stay isolated when the vector base is not line-aligned
+static_assert(offsetof(chi::ingress::Lane, queue_) -
+                  offsetof(chi::ingress::Lane, worker_id_) >=
+              sizeof(chi::i32) + CHI_CACHE_LINE_SIZE);
+static_assert(offsetof(chi::ingress::Lane, emplace_count_) -
+                  offsetof(chi::ingress::Lane, queue_) >=
+              sizeof(chi::ingress::Lane::queue_) + CHI_CACHE_LINE_SIZE);
+static_assert(offsetof(chi::ingress::Lane, pop_count_) -
+                  offsetof(chi::ingress::Lane, emplace_count_) >=
+              sizeof(chi::ingress::Lane::emplace_count_) +
+                  CHI_CACHE_LINE_SIZE);
+static_assert(sizeof(chi::ingress::Lane) -
+                  offsetof(chi::ingress::Lane, pop_count_) >=
+              sizeof(chi::ingress::Lane::pop_count_) + CHI_CACHE_LINE_SIZE);
+// Ingress lane groups never share a line
+static_assert(alignof(chi::ingress::LaneGroup) >= CHI_CACHE_LINE_SIZE);
+static_assert(sizeof(chi::ingress::LaneGroup) % CHI_CACHE_LINE_SIZE == 0);
+// Runtime lanes: counter, load and task queue on distinct lines
+static_assert(alignof(chi::Lane) >= CHI_CACHE_LINE_SIZE);
+static_assert(sizeof(chi::Lane) % CHI_CACHE_LINE_SIZE == 0);
+static_assert(CHI_FIELD_DIST(chi::Lane, worker_id_, count_) >=
+              CHI_CACHE_LINE_SIZE);
+static_assert(CHI_FIELD_DIST(chi::Lane, count_, load_) >= CHI_CACHE_LINE_SIZE);
+static_assert(CHI_FIELD_DIST(chi::Lane, load_, active_tasks_) >=
+              CHI_CACHE_LINE_SIZE);
+static_assert(CHI_FIELD_DIST(chi::Lane, active_tasks_, comux_) >=
+              CHI_CACHE_LINE_SIZE);
+#pragma GCC diagnostic pop
+
+TEST_CASE("TestCacheLineLayout") {
+  HILOG(kInfo, "Size of ingress::Lane: {}", sizeof(chi::ingress::Lane));
+  HILOG(kInfo, "Size of ingress::LaneGroup: {}",
+        sizeof(chi::ingress::LaneGroup));
+  HILOG(kInfo, "Size of Lane: {}", sizeof(chi::Lane));
+}